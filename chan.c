@@ -2344,6 +2344,7 @@ static void rtw89_swap_sub_entity(struct rtw89_dev *rtwdev,
 		else if (rtwvif->sub_entity_idx == idx2)
 			rtwvif->sub_entity_idx = idx1;
 	}
+	rtw89_core_tx_tmpl_invalidate(rtwdev);
 
 	cur = atomic_read(&hal->roc_entity_idx);
 	if (cur == idx1)
@@ -2431,6 +2432,7 @@ void rtw89_chanctx_ops_unassign_vif(struct rtw89_dev *rtwdev,
 	rtwvif->sub_entity_idx = RTW89_SUB_ENTITY_0;
 	rtwvif->chanctx_assigned = false;
 	cfg->ref_count--;
+	rtw89_core_tx_tmpl_invalidate(rtwdev);
 
 	if (cfg->ref_count != 0)
 		goto out;
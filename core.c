@@ -3,6 +3,7 @@
  */
 #include <linux/ip.h>
 #include <linux/udp.h>
+#include <linux/timex.h>
 #include <linux/ieee80211.h>
 
 #include "cam.h"
@@ -17,6 +18,7 @@
 #include "reg.h"
 #include "sar.h"
 #include "ser.h"
+#include "trace.h"
 #include "txrx.h"
 #include "util.h"
 #include "wow.h"
@@ -257,6 +259,8 @@ static void rtw89_traffic_stats_accu(struct rtw89_dev *rtwdev,
 				     struct sk_buff *skb, bool tx)
 {
 	struct ieee80211_hdr *hdr = (struct ieee80211_hdr *)skb->data;
+	struct rtw89_traffic_pcpu *pcpu;
+	unsigned long flags;
 
 	if (tx && ieee80211_is_assoc_req(hdr->frame_control))
 		rtw89_wow_parse_akm(rtwdev, skb);
@@ -268,13 +272,18 @@ static void rtw89_traffic_stats_accu(struct rtw89_dev *rtwdev,
 	    is_multicast_ether_addr(hdr->addr1))
 		return;
 
+	/* TX can be written in process context and interrupted by RX */
+	pcpu = get_cpu_ptr(stats->pcpu);
+	flags = u64_stats_update_begin_irqsave(&pcpu->syncp);
 	if (tx) {
-		stats->tx_cnt++;
-		stats->tx_unicast += skb->len;
+		pcpu->tx_cnt++;
+		pcpu->tx_unicast += skb->len;
 	} else {
-		stats->rx_cnt++;
-		stats->rx_unicast += skb->len;
+		pcpu->rx_cnt++;
+		pcpu->rx_unicast += skb->len;
 	}
+	u64_stats_update_end_irqrestore(&pcpu->syncp, flags);
+	put_cpu_ptr(stats->pcpu);
 }
 
 void rtw89_get_default_chandef(struct cfg80211_chan_def *chandef)
@@ -437,6 +446,7 @@ int rtw89_set_channel(struct rtw89_dev *rtwdev)
 	}
 
 	rtw89_set_entity_state(rtwdev, true);
+	rtw89_core_tx_tmpl_invalidate(rtwdev);
 	return 0;
 }
 
@@ -462,16 +472,31 @@ rtw89_core_get_tx_type(struct rtw89_dev *rtwdev,
 	return RTW89_CORE_TX_TYPE_DATA;
 }
 
+static void rtw89_core_get_ampdu_param(struct ieee80211_sta *sta, u8 tid,
+				       u8 *ampdu_num, u8 *ampdu_density)
+{
+	struct rtw89_sta *rtwsta = (struct rtw89_sta *)sta->drv_priv;
+
+	*ampdu_num = (u8)((rtwsta->ampdu_params[tid].agg_num ?
+			   rtwsta->ampdu_params[tid].agg_num :
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(5, 19, 0) || (RHEL_RELEASE_CODE >= RHEL_RELEASE_VERSION(9, 0)))
+			   4 << sta->deflink.ht_cap.ampdu_factor) - 1);
+	*ampdu_density = sta->deflink.ht_cap.ampdu_density;
+#else
+			   4 << sta->ht_cap.ampdu_factor) - 1);
+	*ampdu_density = sta->ht_cap.ampdu_density;
+#endif
+}
+
 static void
 rtw89_core_tx_update_ampdu_info(struct rtw89_dev *rtwdev,
 				struct rtw89_core_tx_request *tx_req,
-				enum btc_pkt_type pkt_type)
+				enum btc_pkt_type pkt_type,
+				const struct rtw89_tx_desc_tmpl *tmpl)
 {
 	struct ieee80211_sta *sta = tx_req->sta;
 	struct rtw89_tx_desc_info *desc_info = &tx_req->desc_info;
 	struct sk_buff *skb = tx_req->skb;
-	struct rtw89_sta *rtwsta;
-	u8 ampdu_num;
 	u8 tid;
 
 	if (pkt_type == PACKET_EAPOL) {
@@ -487,31 +512,43 @@ rtw89_core_tx_update_ampdu_info(struct rtw89_dev *rtwdev,
 		return;
 	}
 
+	desc_info->agg_en = true;
+	if (tmpl) {
+		desc_info->ampdu_num = tmpl->ampdu_num;
+		desc_info->ampdu_density = tmpl->ampdu_density;
+		return;
+	}
+
 	tid = skb->priority & IEEE80211_QOS_CTL_TAG1D_MASK;
-	rtwsta = (struct rtw89_sta *)sta->drv_priv;
+	rtw89_core_get_ampdu_param(sta, tid, &desc_info->ampdu_num,
+				   &desc_info->ampdu_density);
+}
 
-	ampdu_num = (u8)((rtwsta->ampdu_params[tid].agg_num ?
-			  rtwsta->ampdu_params[tid].agg_num :
-#if (LINUX_VERSION_CODE >= KERNEL_VERSION(5, 19, 0) || (RHEL_RELEASE_CODE >= RHEL_RELEASE_VERSION(9, 0)))
-			  4 << sta->deflink.ht_cap.ampdu_factor) - 1);
-#else
-			  4 << sta->ht_cap.ampdu_factor) - 1);
-#endif
+static void
+rtw89_core_tx_update_sec_seq(struct rtw89_dev *rtwdev,
+			     struct rtw89_tx_desc_info *desc_info,
+			     struct ieee80211_key_conf *key)
+{
+	const struct rtw89_chip_info *chip = rtwdev->chip;
+	u64 pn64;
 
-	desc_info->agg_en = true;
-#if (LINUX_VERSION_CODE >= KERNEL_VERSION(5, 19, 0) || (RHEL_RELEASE_CODE >= RHEL_RELEASE_VERSION(9, 0)))
-	desc_info->ampdu_density = sta->deflink.ht_cap.ampdu_density;
-#else	
-	desc_info->ampdu_density = sta->ht_cap.ampdu_density;
-#endif
-	desc_info->ampdu_num = ampdu_num;
+	if (!chip->hw_sec_hdr)
+		return;
+
+	pn64 = atomic64_inc_return(&key->tx_pn);
+	desc_info->sec_seq[0] = pn64;
+	desc_info->sec_seq[1] = pn64 >> 8;
+	desc_info->sec_seq[2] = pn64 >> 16;
+	desc_info->sec_seq[3] = pn64 >> 24;
+	desc_info->sec_seq[4] = pn64 >> 32;
+	desc_info->sec_seq[5] = pn64 >> 40;
+	desc_info->wp_offset = 1; /* in unit of 8 bytes for security header */
 }
 
 static void
 rtw89_core_tx_update_sec_key(struct rtw89_dev *rtwdev,
 			     struct rtw89_core_tx_request *tx_req)
 {
-	const struct rtw89_chip_info *chip = rtwdev->chip;
 	struct ieee80211_vif *vif = tx_req->vif;
 	struct ieee80211_sta *sta = tx_req->sta;
 	struct ieee80211_tx_info *info;
@@ -523,7 +560,6 @@ rtw89_core_tx_update_sec_key(struct rtw89_dev *rtwdev,
 	struct rtw89_tx_desc_info *desc_info = &tx_req->desc_info;
 	struct sk_buff *skb = tx_req->skb;
 	u8 sec_type = RTW89_SEC_KEY_TYPE_NONE;
-	u64 pn64;
 
 	if (!vif) {
 		rtw89_warn(rtwdev, "cannot set sec key without vif\n");
@@ -573,17 +609,7 @@ rtw89_core_tx_update_sec_key(struct rtw89_dev *rtwdev,
 	desc_info->sec_type = sec_type;
 	desc_info->sec_cam_idx = sec_cam->sec_cam_idx;
 
-	if (!chip->hw_sec_hdr)
-		return;
-
-	pn64 = atomic64_inc_return(&key->tx_pn);
-	desc_info->sec_seq[0] = pn64;
-	desc_info->sec_seq[1] = pn64 >> 8;
-	desc_info->sec_seq[2] = pn64 >> 16;
-	desc_info->sec_seq[3] = pn64 >> 24;
-	desc_info->sec_seq[4] = pn64 >> 32;
-	desc_info->sec_seq[5] = pn64 >> 40;
-	desc_info->wp_offset = 1; /* in unit of 8 bytes for security header */
+	rtw89_core_tx_update_sec_seq(rtwdev, desc_info, key);
 }
 
 static u16 rtw89_core_get_mgmt_rate(struct rtw89_dev *rtwdev,
@@ -635,7 +661,10 @@ rtw89_core_tx_update_mgmt_info(struct rtw89_dev *rtwdev,
 						       rtwvif->sub_entity_idx);
 	u8 qsel, ch_dma;
 
-	qsel = desc_info->hiq ? RTW89_TX_QSEL_B0_HI : RTW89_TX_QSEL_B0_MGMT;
+	if (rtwdev->dbcc_en && rtwvif->mac_idx == RTW89_MAC_1)
+		qsel = desc_info->hiq ? RTW89_TX_QSEL_B1_HI : RTW89_TX_QSEL_B1_MGMT;
+	else
+		qsel = desc_info->hiq ? RTW89_TX_QSEL_B0_HI : RTW89_TX_QSEL_B0_MGMT;
 	ch_dma = rtw89_core_get_ch_dma(rtwdev, qsel);
 
 	desc_info->qsel = qsel;
@@ -823,22 +852,132 @@ static u16 rtw89_core_get_data_rate(struct rtw89_dev *rtwdev,
 #endif
 }
 
-static void
+/* TX of a TID is serialized by mac80211 txq, so a template is not filled
+ * by two contexts at the same time.
+ */
+static void rtw89_core_tx_tmpl_save(struct rtw89_sta *rtwsta, u8 tid, u32 gen,
+				    const struct rtw89_tx_desc_info *desc_info,
+				    struct ieee80211_key_conf *key)
+{
+	struct ieee80211_sta *sta = rtwsta_to_sta(rtwsta);
+	struct rtw89_tx_desc_tmpl *tmpl = &rtwsta->tx_tmpl[tid];
+
+	/* invalidate before touching fields, and publish them by
+	 * smp_store_release() paired with rtw89_core_tx_tmpl_get()
+	 */
+	WRITE_ONCE(tmpl->gen, 0);
+	smp_wmb();
+
+	tmpl->qsel = desc_info->qsel;
+	tmpl->ch_dma = desc_info->ch_dma;
+	tmpl->mac_id = desc_info->mac_id;
+	tmpl->tid_indicate = desc_info->tid_indicate;
+	tmpl->er_cap = desc_info->er_cap;
+	tmpl->data_retry_lowest_rate = desc_info->data_retry_lowest_rate;
+	rtw89_core_get_ampdu_param(sta, tid, &tmpl->ampdu_num,
+				   &tmpl->ampdu_density);
+
+	tmpl->key = key;
+	tmpl->sec_en = desc_info->sec_en;
+	tmpl->sec_keyid = desc_info->sec_keyid;
+	tmpl->sec_type = desc_info->sec_type;
+	tmpl->sec_cam_idx = desc_info->sec_cam_idx;
+
+	smp_store_release(&tmpl->gen, gen);
+}
+
+static const struct rtw89_tx_desc_tmpl *
+rtw89_core_tx_tmpl_get(struct rtw89_sta *rtwsta, u8 tid, u32 gen)
+{
+	const struct rtw89_tx_desc_tmpl *tmpl = &rtwsta->tx_tmpl[tid];
+
+	if (smp_load_acquire(&tmpl->gen) != gen)
+		return NULL;
+
+	return tmpl;
+}
+
+static const struct rtw89_tx_desc_tmpl *
+rtw89_core_tx_update_data_info_tmpl(struct rtw89_dev *rtwdev,
+				    struct rtw89_core_tx_request *tx_req,
+				    struct rtw89_sta *rtwsta, u8 tid, u32 gen)
+{
+	struct rtw89_tx_desc_info *desc_info = &tx_req->desc_info;
+	struct ieee80211_key_conf *key;
+	const struct rtw89_tx_desc_tmpl *tmpl;
+
+	tmpl = rtw89_core_tx_tmpl_get(rtwsta, tid, gen);
+	if (!tmpl)
+		return NULL;
+
+	desc_info->ch_dma = tmpl->ch_dma;
+	desc_info->tid_indicate = tmpl->tid_indicate;
+	desc_info->qsel = tmpl->qsel;
+	desc_info->mac_id = tmpl->mac_id;
+	desc_info->port = 0;
+	desc_info->er_cap = tmpl->er_cap;
+	desc_info->en_wd_info = true;
+	desc_info->data_retry_lowest_rate = tmpl->data_retry_lowest_rate;
+
+	key = IEEE80211_SKB_CB(tx_req->skb)->control.hw_key;
+	if (!key)
+		return tmpl;
+
+	if (key != tmpl->key) {
+		rtw89_core_tx_update_sec_key(rtwdev, tx_req);
+		return tmpl;
+	}
+
+	if (!tmpl->sec_en)
+		return tmpl;
+
+	desc_info->sec_en = true;
+	desc_info->sec_keyid = tmpl->sec_keyid;
+	desc_info->sec_type = tmpl->sec_type;
+	desc_info->sec_cam_idx = tmpl->sec_cam_idx;
+	rtw89_core_tx_update_sec_seq(rtwdev, desc_info, key);
+
+	return tmpl;
+}
+
+static const struct rtw89_tx_desc_tmpl *
 rtw89_core_tx_update_data_info(struct rtw89_dev *rtwdev,
 			       struct rtw89_core_tx_request *tx_req)
 {
+	struct rtw89_tx_desc_stats *desc_stats = &rtwdev->tx_desc_stats;
 	struct ieee80211_vif *vif = tx_req->vif;
 	struct ieee80211_sta *sta = tx_req->sta;
 	struct rtw89_vif *rtwvif = (struct rtw89_vif *)vif->drv_priv;
 	struct rtw89_sta *rtwsta = sta_to_rtwsta_safe(sta);
 	struct rtw89_tx_desc_info *desc_info = &tx_req->desc_info;
+	const struct rtw89_tx_desc_tmpl *tmpl;
 	struct sk_buff *skb = tx_req->skb;
+	struct ieee80211_key_conf *key;
+	bool use_tmpl;
 	u8 tid, tid_indicate;
 	u8 qsel, ch_dma;
+	u32 gen;
 
 	tid = skb->priority & IEEE80211_QOS_CTL_TAG1D_MASK;
+	gen = atomic_read(&rtwdev->tx_tmpl_gen);
+	use_tmpl = rtwsta && !desc_info->hiq;
+	if (use_tmpl) {
+		tmpl = rtw89_core_tx_update_data_info_tmpl(rtwdev, tx_req,
+							   rtwsta, tid, gen);
+		if (desc_stats->enabled)
+			atomic64_inc(tmpl ? &desc_stats->tmpl_hit :
+					    &desc_stats->tmpl_miss);
+		if (tmpl)
+			return tmpl;
+	}
+
 	tid_indicate = rtw89_core_get_tid_indicate(rtwdev, tid);
-	qsel = desc_info->hiq ? RTW89_TX_QSEL_B0_HI : rtw89_core_get_qsel(rtwdev, tid);
+	if (!desc_info->hiq)
+		qsel = rtw89_core_get_qsel_band(rtwdev, tid, rtwvif->mac_idx);
+	else if (rtwdev->dbcc_en && rtwvif->mac_idx == RTW89_MAC_1)
+		qsel = RTW89_TX_QSEL_B1_HI;
+	else
+		qsel = RTW89_TX_QSEL_B0_HI;
 	ch_dma = rtw89_core_get_ch_dma(rtwdev, qsel);
 
 	desc_info->ch_dma = ch_dma;
@@ -851,10 +990,16 @@ rtw89_core_tx_update_data_info(struct rtw89_dev *rtwdev,
 	/* enable wd_info for AMPDU */
 	desc_info->en_wd_info = true;
 
-	if (IEEE80211_SKB_CB(skb)->control.hw_key)
+	key = IEEE80211_SKB_CB(skb)->control.hw_key;
+	if (key)
 		rtw89_core_tx_update_sec_key(rtwdev, tx_req);
 
 	desc_info->data_retry_lowest_rate = rtw89_core_get_data_rate(rtwdev, tx_req);
+
+	if (use_tmpl)
+		rtw89_core_tx_tmpl_save(rtwsta, tid, gen, desc_info, key);
+
+	return NULL;
 }
 
 static enum btc_pkt_type
@@ -932,6 +1077,7 @@ rtw89_core_tx_update_desc_info(struct rtw89_dev *rtwdev,
 	struct sk_buff *skb = tx_req->skb;
 	struct ieee80211_tx_info *info = IEEE80211_SKB_CB(skb);
 	struct ieee80211_hdr *hdr = (void *)skb->data;
+	const struct rtw89_tx_desc_tmpl *tmpl;
 	enum rtw89_core_tx_type tx_type;
 	enum btc_pkt_type pkt_type;
 	bool is_bmc;
@@ -956,10 +1102,10 @@ rtw89_core_tx_update_desc_info(struct rtw89_dev *rtwdev,
 		rtw89_core_tx_update_mgmt_info(rtwdev, tx_req);
 		break;
 	case RTW89_CORE_TX_TYPE_DATA:
-		rtw89_core_tx_update_data_info(rtwdev, tx_req);
+		tmpl = rtw89_core_tx_update_data_info(rtwdev, tx_req);
 		pkt_type = rtw89_core_tx_btc_spec_pkt_notify(rtwdev, tx_req);
 		rtw89_core_tx_update_he_qos_htc(rtwdev, tx_req, pkt_type);
-		rtw89_core_tx_update_ampdu_info(rtwdev, tx_req, pkt_type);
+		rtw89_core_tx_update_ampdu_info(rtwdev, tx_req, pkt_type, tmpl);
 		rtw89_core_tx_update_llc_hdr(rtwdev, desc_info, skb);
 		break;
 	case RTW89_CORE_TX_TYPE_FWCMD:
@@ -1033,6 +1179,8 @@ int rtw89_h2c_tx(struct rtw89_dev *rtwdev,
 	if (!fwdl)
 		rtw89_hex_dump(rtwdev, RTW89_DBG_FW, "H2C: ", skb->data, skb->len);
 
+	trace_rtw89_h2c_tx(rtwdev, skb, fwdl);
+
 	cnt = rtw89_hci_check_and_reclaim_tx_resource(rtwdev, RTW89_TXCH_CH12);
 	if (cnt == 0) {
 		rtw89_err(rtwdev, "no tx fwcmd resource\n");
@@ -1049,22 +1197,43 @@ int rtw89_h2c_tx(struct rtw89_dev *rtwdev,
 	return 0;
 }
 
+/* enabled while any device samples TX latency, so TX path only pays a
+ * patched-out branch when none does
+ */
+static DEFINE_STATIC_KEY_FALSE(rtw89_tx_lat_key);
+
 int rtw89_core_tx_write(struct rtw89_dev *rtwdev, struct ieee80211_vif *vif,
 			struct ieee80211_sta *sta, struct sk_buff *skb, int *qsel)
 {
+	struct rtw89_tx_desc_stats *desc_stats = &rtwdev->tx_desc_stats;
 	struct rtw89_core_tx_request tx_req = {0};
 	struct rtw89_vif *rtwvif = (struct rtw89_vif *)vif->drv_priv;
+	cycles_t start;
 	int ret;
 
 	tx_req.skb = skb;
 	tx_req.sta = sta;
 	tx_req.vif = vif;
 
+	if (static_branch_unlikely(&rtw89_tx_lat_key) &&
+	    READ_ONCE(rtwdev->tx_lat_stats.enabled))
+		tx_req.enqueue_ts = ktime_get();
+
 	rtw89_traffic_stats_accu(rtwdev, &rtwdev->stats, skb, true);
 	rtw89_traffic_stats_accu(rtwdev, &rtwvif->stats, skb, true);
-	rtw89_core_tx_update_desc_info(rtwdev, &tx_req);
+
+	if (unlikely(desc_stats->enabled)) {
+		start = get_cycles();
+		rtw89_core_tx_update_desc_info(rtwdev, &tx_req);
+		atomic64_add(get_cycles() - start, &desc_stats->cycles);
+		atomic64_inc(&desc_stats->cnt);
+	} else {
+		rtw89_core_tx_update_desc_info(rtwdev, &tx_req);
+	}
 	rtw89_core_tx_wake(rtwdev, &tx_req);
 
+	trace_rtw89_core_tx_write(rtwdev, &tx_req.desc_info);
+
 	ret = rtw89_hci_tx_write(rtwdev, &tx_req);
 	if (ret) {
 		rtw89_err(rtwdev, "failed to transmit skb to HCI\n");
@@ -1077,6 +1246,122 @@ int rtw89_core_tx_write(struct rtw89_dev *rtwdev, struct ieee80211_vif *vif,
 	return 0;
 }
 
+static void rtw89_tx_lat_hist_add(struct rtw89_tx_lat_hist *hist,
+				  const s64 *us)
+{
+	u32 bucket;
+	int i;
+
+	for (i = 0; i < RTW89_TX_LAT_STAGE_NUM; i++) {
+		if (us[i] < 0)
+			continue;
+
+		bucket = us[i] > 1 ? ilog2(us[i]) : 0;
+		bucket = min_t(u32, bucket, RTW89_TX_LAT_BUCKETS - 1);
+		hist->cnt[i][bucket]++;
+	}
+}
+
+static void rtw89_sta_tx_lat_reset_iter(void *data, struct ieee80211_sta *sta)
+{
+	struct rtw89_sta *rtwsta = (struct rtw89_sta *)sta->drv_priv;
+
+	memset(&rtwsta->tx_lat, 0, sizeof(rtwsta->tx_lat));
+}
+
+void rtw89_core_tx_lat_enable(struct rtw89_dev *rtwdev, bool enable)
+{
+	struct rtw89_tx_lat_stats *lat_stats = &rtwdev->tx_lat_stats;
+
+	lockdep_assert_held(&rtwdev->mutex);
+
+	if (lat_stats->enabled) {
+		WRITE_ONCE(lat_stats->enabled, false);
+		static_branch_dec(&rtw89_tx_lat_key);
+	}
+
+	if (!enable)
+		return;
+
+	memset(lat_stats->ac, 0, sizeof(lat_stats->ac));
+	ieee80211_iterate_stations_atomic(rtwdev->hw,
+					  rtw89_sta_tx_lat_reset_iter, NULL);
+	WRITE_ONCE(lat_stats->enabled, true);
+	static_branch_inc(&rtw89_tx_lat_key);
+}
+
+/* Called by HCI with the release report of a sampled frame, serialized
+ * by the report processing.
+ */
+void rtw89_core_tx_lat_report(struct rtw89_dev *rtwdev, u8 mac_id, u8 ac,
+			      ktime_t enqueue, ktime_t kick)
+{
+	struct rtw89_tx_lat_stats *lat_stats = &rtwdev->tx_lat_stats;
+	s64 us[RTW89_TX_LAT_STAGE_NUM];
+	struct rtw89_sta *rtwsta;
+	ktime_t now;
+
+	if (!READ_ONCE(lat_stats->enabled) || ac >= IEEE80211_NUM_ACS)
+		return;
+
+	now = ktime_get();
+	us[RTW89_TX_LAT_TOTAL] = ktime_us_delta(now, enqueue);
+	/* doorbell isn't stamped if sampling started in between */
+	us[RTW89_TX_LAT_DRV] = kick ? ktime_us_delta(kick, enqueue) : -1;
+	us[RTW89_TX_LAT_HW] = kick ? ktime_us_delta(now, kick) : -1;
+
+	rtw89_tx_lat_hist_add(&lat_stats->ac[ac], us);
+
+	rcu_read_lock();
+	rtwsta = rtw89_sta_rcu_dereference(rtwdev, mac_id);
+	if (rtwsta)
+		rtw89_tx_lat_hist_add(&rtwsta->tx_lat, us);
+	rcu_read_unlock();
+}
+EXPORT_SYMBOL(rtw89_core_tx_lat_report);
+
+/* Airtime of the payload only, as preamble and inter-frame overhead are
+ * shared by the frames in an aggregate. @bitrate is in units of 100 kbps.
+ */
+static u32 rtw89_core_airtime_us(u32 bitrate, u32 len)
+{
+	if (!bitrate)
+		return 0;
+
+	return DIV_ROUND_UP(len * 80, bitrate);
+}
+
+/* Called by HCI with the release report of a data frame of a station.
+ * Dropped frames never went on air, so only frames which were sent, even
+ * if not acked, are charged by the rate of the latest RA report.
+ */
+void rtw89_core_tx_airtime_report(struct rtw89_dev *rtwdev, u8 mac_id, u8 tid,
+				  u32 len, bool sent)
+{
+	struct ieee80211_sta *sta;
+	struct rtw89_sta *rtwsta;
+	u32 airtime;
+
+	if (!len || !sent)
+		return;
+
+	rcu_read_lock();
+	rtwsta = rtw89_sta_rcu_dereference(rtwdev, mac_id);
+	if (!rtwsta)
+		goto out;
+
+	airtime = rtw89_core_airtime_us(READ_ONCE(rtwsta->ra_report.bit_rate), len);
+	if (!airtime)
+		goto out;
+
+	sta = rtwsta_to_sta(rtwsta);
+	atomic64_add(airtime, &rtwsta->tx_airtime);
+	ieee80211_sta_register_airtime(sta, tid, airtime, 0);
+out:
+	rcu_read_unlock();
+}
+EXPORT_SYMBOL(rtw89_core_tx_airtime_report);
+
 static __le32 rtw89_build_txwd_body0(struct rtw89_tx_desc_info *desc_info)
 {
 	u32 dword = FIELD_PREP(RTW89_TXWD_BODY0_WP_OFFSET, desc_info->wp_offset) |
@@ -1506,11 +1791,9 @@ static int rtw89_core_rx_process_mac_ppdu(struct rtw89_dev *rtwdev,
 	return 0;
 }
 
-static void rtw89_core_rx_process_phy_ppdu_iter(void *data,
-						struct ieee80211_sta *sta)
+static void rtw89_core_rx_process_phy_ppdu_sta(struct rtw89_sta *rtwsta,
+					       struct rtw89_rx_phy_ppdu *phy_ppdu)
 {
-	struct rtw89_sta *rtwsta = (struct rtw89_sta *)sta->drv_priv;
-	struct rtw89_rx_phy_ppdu *phy_ppdu = (struct rtw89_rx_phy_ppdu *)data;
 	struct rtw89_dev *rtwdev = rtwsta->rtwdev;
 	struct rtw89_hal *hal = &rtwdev->hal;
 	u8 ant_num = hal->ant_diversity ? 2 : rtwdev->chip->rf_path_num;
@@ -1518,7 +1801,7 @@ static void rtw89_core_rx_process_phy_ppdu_iter(void *data,
 	u8 evm_pos = 0;
 	int i;
 
-	if (rtwsta->mac_id != phy_ppdu->mac_id || !phy_ppdu->to_self)
+	if (!phy_ppdu->to_self)
 		return;
 
 	if (hal->ant_diversity && hal->antenna_rx) {
@@ -1696,6 +1979,7 @@ static int rtw89_core_rx_parse_phy_sts(struct rtw89_dev *rtwdev,
 static void rtw89_core_rx_process_phy_sts(struct rtw89_dev *rtwdev,
 					  struct rtw89_rx_phy_ppdu *phy_ppdu)
 {
+	struct rtw89_sta *rtwsta;
 	int ret;
 
 	ret = rtw89_core_rx_parse_phy_sts(rtwdev, phy_ppdu);
@@ -1704,9 +1988,13 @@ static void rtw89_core_rx_process_phy_sts(struct rtw89_dev *rtwdev,
 	else
 		phy_ppdu->valid = true;
 
-	ieee80211_iterate_stations_atomic(rtwdev->hw,
-					  rtw89_core_rx_process_phy_ppdu_iter,
-					  phy_ppdu);
+	rcu_read_lock();
+
+	rtwsta = rtw89_sta_rcu_dereference(rtwdev, phy_ppdu->mac_id);
+	if (rtwsta)
+		rtw89_core_rx_process_phy_ppdu_sta(rtwsta, phy_ppdu);
+
+	rcu_read_unlock();
 }
 
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 18, 0)
@@ -1769,15 +2057,20 @@ static u8 rtw89_rxdesc_to_nl_he_gi(struct rtw89_dev *rtwdev,
 }
 #endif
 
-static bool rtw89_core_rx_ppdu_match(struct rtw89_dev *rtwdev,
-				     struct rtw89_rx_desc_info *desc_info,
-				     struct ieee80211_rx_status *status)
+/* rate of a PPDU status, which held frames are checked against */
+struct rtw89_rx_ppdu_key {
+	u8 rate_idx;
+	u8 bw;
+	u8 gi_ltf;
+	bool eht;
+};
+
+static void rtw89_core_rx_ppdu_key(struct rtw89_dev *rtwdev,
+				   struct rtw89_rx_desc_info *desc_info,
+				   struct rtw89_rx_ppdu_key *key)
 {
-	u8 band = desc_info->bb_sel ? RTW89_PHY_1 : RTW89_PHY_0;
-	u8 data_rate_mode, bw, rate_idx = MASKBYTE0, gi_ltf;
-	bool eht = false;
+	u8 data_rate_mode, rate_idx = MASKBYTE0;
 	u16 data_rate;
-	bool ret;
 
 	data_rate = desc_info->data_rate;
 	data_rate_mode = rtw89_get_data_rate_mode(rtwdev, data_rate);
@@ -1794,30 +2087,33 @@ static bool rtw89_core_rx_ppdu_match(struct rtw89_dev *rtwdev,
 		rtw89_warn(rtwdev, "invalid RX rate mode %d\n", data_rate_mode);
 	}
 
+	key->rate_idx = rate_idx;
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 3, 0)
-	eht = data_rate_mode == DATA_RATE_MODE_EHT;
+	key->eht = data_rate_mode == DATA_RATE_MODE_EHT;
 #else
-	eht = 0;
+	key->eht = false;
 #endif
-	bw = rtw89_hw_to_rate_info_bw(desc_info->bw);
+	key->bw = rtw89_hw_to_rate_info_bw(desc_info->bw);
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 3, 0)
-	gi_ltf = rtw89_rxdesc_to_nl_he_eht_gi(rtwdev, desc_info->gi_ltf, false, eht);
+	key->gi_ltf = rtw89_rxdesc_to_nl_he_eht_gi(rtwdev, desc_info->gi_ltf,
+						   false, key->eht);
 #else
-	gi_ltf = 0;
+	key->gi_ltf = 0;
 #endif
+}
+
+static bool rtw89_core_rx_ppdu_match(const struct rtw89_rx_ppdu_key *key,
+				     struct ieee80211_rx_status *status)
+{
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 3, 0)
-	ret = rtwdev->ppdu_sts.curr_rx_ppdu_cnt[band] == desc_info->ppdu_cnt &&
-	      status->rate_idx == rate_idx &&
-	      rtw89_check_rx_statu_gi_match(status, gi_ltf, eht) &&
-	      status->bw == bw;
+	return status->rate_idx == key->rate_idx &&
+	       rtw89_check_rx_statu_gi_match(status, key->gi_ltf, key->eht) &&
+	       status->bw == key->bw;
 #else
-	ret = rtwdev->ppdu_sts.curr_rx_ppdu_cnt[band] == desc_info->ppdu_cnt &&
-	      status->rate_idx == rate_idx &&
-	      status->he_gi == gi_ltf &&
-	      status->bw == bw;
+	return status->rate_idx == key->rate_idx &&
+	       status->he_gi == key->gi_ltf &&
+	       status->bw == key->bw;
 #endif
-
-	return ret;
 }
 
 struct rtw89_vif_rx_stats_iter_data {
@@ -2158,49 +2454,160 @@ static void rtw89_core_rx_to_mac80211(struct rtw89_dev *rtwdev,
 				      struct sk_buff *skb_ppdu,
 				      struct ieee80211_rx_status *rx_status)
 {
-	struct napi_struct *napi = &rtwdev->napi;
-
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 7, 0)
-	/* In low power mode, napi isn't scheduled. Receive it to netif. */
-	if (unlikely(!napi_is_scheduled(napi)))
-		napi = NULL;
-#else
-	napi = NULL;
-#endif
-
 	rtw89_core_hw_to_sband_rate(rx_status);
 	rtw89_core_rx_stats(rtwdev, phy_ppdu, desc_info, skb_ppdu);
 	rtw89_core_update_radiotap(rtwdev, skb_ppdu, rx_status);
-	/* In low power mode, it does RX in thread context. */
-	local_bh_disable();
-	ieee80211_rx_napi(rtwdev->hw, NULL, skb_ppdu, napi);
-	local_bh_enable();
 	rtwdev->napi_budget_countdown--;
+
+	/* RX is always served by NAPI poll, including low power mode, so list
+	 * delivery is chosen by kernel version only, not by NAPI state.
+	 * Kernels before 6.7 pass frames one at a time.
+	 */
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 7, 0)
+	/* Collect frames of this poll, and rtw89_core_napi_rx_flush() hands
+	 * them up to netif at the end of the poll.
+	 */
+	rcu_read_lock();
+	ieee80211_rx_list(rtwdev->hw, NULL, skb_ppdu, &rtwdev->napi_rx_list);
+	rcu_read_unlock();
+#else
+	ieee80211_rx_napi(rtwdev->hw, NULL, skb_ppdu, &rtwdev->napi);
+#endif
 }
 
-static void rtw89_core_rx_pending_skb(struct rtw89_dev *rtwdev,
-				      struct rtw89_rx_phy_ppdu *phy_ppdu,
+static void rtw89_core_ppdu_slot_hold(struct rtw89_dev *rtwdev, u8 band,
 				      struct rtw89_rx_desc_info *desc_info,
 				      struct sk_buff *skb)
 {
-	u8 band = desc_info->bb_sel ? RTW89_PHY_1 : RTW89_PHY_0;
-	int curr = rtwdev->ppdu_sts.curr_rx_ppdu_cnt[band];
-	struct sk_buff *skb_ppdu = NULL, *tmp;
+	struct rtw89_ppdu_sts_info *ppdu_sts = &rtwdev->ppdu_sts;
+	u8 idx = desc_info->ppdu_cnt;
+	struct rtw89_ppdu_slot *slot = &ppdu_sts->slots[band][idx];
+
+	if (skb_queue_empty(&slot->frames)) {
+		/* frames of a PPDU share the rate fields of RX desc */
+		slot->desc = *desc_info;
+		slot->since = ktime_get();
+		__set_bit(idx, &ppdu_sts->pending[band]);
+	}
+
+	__skb_queue_tail(&slot->frames, skb);
+	ppdu_sts->stats.held++;
+}
+
+/* Hand frames held in a slot up to mac80211, with PHY status if @phy_ppdu
+ * and @sts_desc of the PPDU status are given.
+ */
+static void rtw89_core_ppdu_slot_release(struct rtw89_dev *rtwdev, u8 band,
+					 u8 idx, struct rtw89_rx_phy_ppdu *phy_ppdu,
+					 struct rtw89_rx_desc_info *sts_desc,
+					 u64 *nosts_cnt)
+{
+	struct rtw89_ppdu_sts_info *ppdu_sts = &rtwdev->ppdu_sts;
+	struct rtw89_ppdu_slot *slot = &ppdu_sts->slots[band][idx];
+	struct rtw89_ppdu_sts_stats *stats = &ppdu_sts->stats;
 	struct ieee80211_rx_status *rx_status;
+	struct rtw89_rx_ppdu_key key;
+	struct sk_buff *skb;
+	u32 hold_us;
 
-	if (curr > RTW89_MAX_PPDU_CNT)
+	if (!test_bit(idx, &ppdu_sts->pending[band]))
 		return;
 
-	skb_queue_walk_safe(&rtwdev->ppdu_sts.rx_queue[band], skb_ppdu, tmp) {
-		skb_unlink(skb_ppdu, &rtwdev->ppdu_sts.rx_queue[band]);
-		rx_status = IEEE80211_SKB_RXCB(skb_ppdu);
-		if (rtw89_core_rx_ppdu_match(rtwdev, desc_info, rx_status))
+	__clear_bit(idx, &ppdu_sts->pending[band]);
+
+	hold_us = ktime_us_delta(ktime_get(), slot->since);
+	stats->hold_cnt++;
+	stats->hold_total_us += hold_us;
+	stats->hold_max_us = max(stats->hold_max_us, hold_us);
+
+	if (phy_ppdu)
+		rtw89_core_rx_ppdu_key(rtwdev, sts_desc, &key);
+
+	while ((skb = __skb_dequeue(&slot->frames))) {
+		rx_status = IEEE80211_SKB_RXCB(skb);
+		if (!phy_ppdu) {
+			(*nosts_cnt)++;
+		} else if (rtw89_core_rx_ppdu_match(&key, rx_status)) {
 			rtw89_chip_query_ppdu(rtwdev, phy_ppdu, rx_status);
-		rtw89_correct_cck_chan(rtwdev, rx_status);
-		rtw89_core_rx_to_mac80211(rtwdev, phy_ppdu, desc_info, skb_ppdu, rx_status);
+			stats->matched++;
+		} else {
+			stats->unmatched++;
+		}
+		if (phy_ppdu)
+			rtw89_correct_cck_chan(rtwdev, rx_status);
+		rtw89_core_rx_to_mac80211(rtwdev, phy_ppdu, &slot->desc, skb, rx_status);
+	}
+}
+
+/* ppdu_cnt only moves forward, so pending slots other than @idx belong to
+ * earlier PPDUs. Hand them up oldest first to keep RX in order.
+ */
+static void rtw89_core_ppdu_slot_flush_older(struct rtw89_dev *rtwdev, u8 band,
+					     u8 idx)
+{
+	struct rtw89_ppdu_sts_info *ppdu_sts = &rtwdev->ppdu_sts;
+	u8 i, older;
+
+	for (i = 1; i < RTW89_MAX_PPDU_CNT && ppdu_sts->pending[band]; i++) {
+		older = (idx + i) % RTW89_MAX_PPDU_CNT;
+		rtw89_core_ppdu_slot_release(rtwdev, band, older, NULL, NULL,
+					     &ppdu_sts->stats.evicted);
 	}
 }
 
+/* Don't let frames wait for a PPDU status which may never come. */
+static void rtw89_core_ppdu_sts_expire(struct rtw89_dev *rtwdev)
+{
+	struct rtw89_ppdu_sts_info *ppdu_sts = &rtwdev->ppdu_sts;
+	ktime_t now, expires, next = 0;
+	unsigned long idx;
+	u8 band;
+
+	if (!ppdu_sts->pending[RTW89_PHY_0] && !ppdu_sts->pending[RTW89_PHY_1])
+		return;
+
+	now = ktime_get();
+
+	for (band = RTW89_PHY_0; band < RTW89_PHY_MAX; band++) {
+		for_each_set_bit(idx, &ppdu_sts->pending[band], RTW89_MAX_PPDU_CNT) {
+			expires = ktime_add_us(ppdu_sts->slots[band][idx].since,
+					       RTW89_PPDU_STS_HOLD_US);
+			if (!ktime_before(now, expires))
+				rtw89_core_ppdu_slot_release(rtwdev, band, idx, NULL, NULL,
+							     &ppdu_sts->stats.expired);
+			else if (!next || ktime_before(expires, next))
+				next = expires;
+		}
+	}
+
+	if (next)
+		hrtimer_start(&ppdu_sts->hold_timer, next, HRTIMER_MODE_ABS);
+}
+
+static void rtw89_core_ppdu_sts_purge(struct rtw89_dev *rtwdev)
+{
+	struct rtw89_ppdu_sts_info *ppdu_sts = &rtwdev->ppdu_sts;
+	int i, j;
+
+	for (i = 0; i < RTW89_PHY_MAX; i++) {
+		for (j = 0; j < RTW89_MAX_PPDU_CNT; j++)
+			__skb_queue_purge(&ppdu_sts->slots[i][j].frames);
+		ppdu_sts->pending[i] = 0;
+		ppdu_sts->curr_rx_ppdu_cnt[i] = U8_MAX;
+	}
+}
+
+static enum hrtimer_restart rtw89_core_ppdu_sts_hold_timer(struct hrtimer *timer)
+{
+	struct rtw89_dev *rtwdev = container_of(timer, struct rtw89_dev,
+						ppdu_sts.hold_timer);
+
+	/* RX is served by NAPI only, so expire held frames over there */
+	napi_schedule(&rtwdev->napi);
+
+	return HRTIMER_NORESTART;
+}
+
 static void rtw89_core_rx_process_ppdu_sts(struct rtw89_dev *rtwdev,
 					   struct rtw89_rx_desc_info *desc_info,
 					   struct sk_buff *skb)
@@ -2210,6 +2617,7 @@ static void rtw89_core_rx_process_ppdu_sts(struct rtw89_dev *rtwdev,
 					     .to_self = desc_info->addr1_match,
 					     .rate = desc_info->data_rate,
 					     .mac_id = desc_info->mac_id};
+	u8 band = desc_info->bb_sel ? RTW89_PHY_1 : RTW89_PHY_0;
 	int ret;
 
 	if (desc_info->mac_info_valid) {
@@ -2225,7 +2633,9 @@ static void rtw89_core_rx_process_ppdu_sts(struct rtw89_dev *rtwdev,
 	rtw89_core_rx_process_phy_sts(rtwdev, &phy_ppdu);
 
 out:
-	rtw89_core_rx_pending_skb(rtwdev, &phy_ppdu, desc_info, skb);
+	rtw89_core_ppdu_slot_flush_older(rtwdev, band, desc_info->ppdu_cnt);
+	rtw89_core_ppdu_slot_release(rtwdev, band, desc_info->ppdu_cnt,
+				     &phy_ppdu, desc_info, NULL);
 	dev_kfree_skb_any(skb);
 }
 
@@ -2367,35 +2777,89 @@ void rtw89_core_query_rxdesc_v2(struct rtw89_dev *rtwdev,
 }
 EXPORT_SYMBOL(rtw89_core_query_rxdesc_v2);
 
-struct rtw89_core_iter_rx_status {
-	struct rtw89_dev *rtwdev;
-	struct ieee80211_rx_status *rx_status;
-	struct rtw89_rx_desc_info *desc_info;
-	u8 mac_id;
-};
-
-static
-void rtw89_core_stats_sta_rx_status_iter(void *data, struct ieee80211_sta *sta)
+static void rtw89_core_stats_sta_rx_status(struct rtw89_dev *rtwdev,
+					   struct rtw89_rx_desc_info *desc_info,
+					   struct ieee80211_rx_status *rx_status)
 {
-	struct rtw89_core_iter_rx_status *iter_data =
-				(struct rtw89_core_iter_rx_status *)data;
-	struct ieee80211_rx_status *rx_status = iter_data->rx_status;
-	struct rtw89_sta *rtwsta = (struct rtw89_sta *)sta->drv_priv;
-	struct rtw89_rx_desc_info *desc_info = iter_data->desc_info;
-	u8 mac_id = iter_data->mac_id;
+	struct rtw89_sta *rtwsta;
 
-	if (mac_id != rtwsta->mac_id)
+	if (!desc_info->addr1_match || !desc_info->long_rxdesc)
+		return;
+
+	if (desc_info->frame_type != RTW89_RX_TYPE_DATA)
 		return;
 
-	rtwsta->rx_status = *rx_status;
-	rtwsta->rx_hw_rate = desc_info->data_rate;
+	rcu_read_lock();
+
+	rtwsta = rtw89_sta_rcu_dereference(rtwdev, desc_info->mac_id);
+	if (rtwsta) {
+		rtwsta->rx_status = *rx_status;
+		rtwsta->rx_hw_rate = desc_info->data_rate;
+	}
+
+	rcu_read_unlock();
 }
 
-static void rtw89_core_stats_sta_rx_status(struct rtw89_dev *rtwdev,
-					   struct rtw89_rx_desc_info *desc_info,
+static u32 rtw89_core_rx_status_to_bitrate(struct rtw89_dev *rtwdev,
 					   struct ieee80211_rx_status *rx_status)
 {
-	struct rtw89_core_iter_rx_status iter_data;
+	struct rate_info rate = {};
+	u16 legacy_bitrate;
+
+	rate.bw = rx_status->bw;
+
+	switch (rx_status->encoding) {
+	case RX_ENC_LEGACY:
+		/* rate_idx is still the hardware rate index here */
+		if (!rtw89_ra_report_to_bitrate(rtwdev, rx_status->rate_idx,
+						&legacy_bitrate))
+			return 0;
+		rate.legacy = legacy_bitrate;
+		break;
+	case RX_ENC_HT:
+		rate.flags |= RATE_INFO_FLAGS_MCS;
+		rate.mcs = rx_status->rate_idx;
+		if (rx_status->enc_flags & RX_ENC_FLAG_SHORT_GI)
+			rate.flags |= RATE_INFO_FLAGS_SHORT_GI;
+		break;
+	case RX_ENC_VHT:
+		rate.flags |= RATE_INFO_FLAGS_VHT_MCS;
+		rate.mcs = rx_status->rate_idx;
+		rate.nss = rx_status->nss;
+		if (rx_status->enc_flags & RX_ENC_FLAG_SHORT_GI)
+			rate.flags |= RATE_INFO_FLAGS_SHORT_GI;
+		break;
+	case RX_ENC_HE:
+		rate.flags |= RATE_INFO_FLAGS_HE_MCS;
+		rate.mcs = rx_status->rate_idx;
+		rate.nss = rx_status->nss;
+		rate.he_gi = rx_status->he_gi;
+		break;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 3, 0)
+	case RX_ENC_EHT:
+		rate.flags |= RATE_INFO_FLAGS_EHT_MCS;
+		rate.mcs = rx_status->rate_idx;
+		rate.nss = rx_status->nss;
+		rate.eht_gi = rx_status->eht.gi;
+		break;
+#endif
+	default:
+		return 0;
+	}
+
+	return cfg80211_calculate_bitrate(&rate);
+}
+
+static void rtw89_core_stats_sta_rx_airtime(struct rtw89_dev *rtwdev,
+					    struct rtw89_rx_desc_info *desc_info,
+					    struct ieee80211_rx_status *rx_status,
+					    struct sk_buff *skb)
+{
+	struct ieee80211_hdr *hdr = (struct ieee80211_hdr *)skb->data;
+	struct ieee80211_sta *sta;
+	struct rtw89_sta *rtwsta;
+	u32 bitrate, airtime;
+	u8 tid = 0;
 
 	if (!desc_info->addr1_match || !desc_info->long_rxdesc)
 		return;
@@ -2403,13 +2867,24 @@ static void rtw89_core_stats_sta_rx_status(struct rtw89_dev *rtwdev,
 	if (desc_info->frame_type != RTW89_RX_TYPE_DATA)
 		return;
 
-	iter_data.rtwdev = rtwdev;
-	iter_data.rx_status = rx_status;
-	iter_data.desc_info = desc_info;
-	iter_data.mac_id = desc_info->mac_id;
-	ieee80211_iterate_stations_atomic(rtwdev->hw,
-					  rtw89_core_stats_sta_rx_status_iter,
-					  &iter_data);
+	bitrate = rtw89_core_rx_status_to_bitrate(rtwdev, rx_status);
+	airtime = rtw89_core_airtime_us(bitrate, desc_info->pkt_size);
+	if (!airtime)
+		return;
+
+	if (ieee80211_is_data_qos(hdr->frame_control))
+		tid = ieee80211_get_tid(hdr);
+
+	rcu_read_lock();
+
+	rtwsta = rtw89_sta_rcu_dereference(rtwdev, desc_info->mac_id);
+	if (rtwsta) {
+		sta = rtwsta_to_sta(rtwsta);
+		atomic64_add(airtime, &rtwsta->rx_airtime);
+		ieee80211_sta_register_airtime(sta, tid, 0, airtime);
+	}
+
+	rcu_read_unlock();
 }
 
 static void rtw89_core_update_rx_status(struct rtw89_dev *rtwdev,
@@ -2522,21 +2997,6 @@ static enum rtw89_ps_mode rtw89_update_ps_mode(struct rtw89_dev *rtwdev)
 	return RTW89_PS_MODE_NONE;
 }
 
-static void rtw89_core_flush_ppdu_rx_queue(struct rtw89_dev *rtwdev,
-					   struct rtw89_rx_desc_info *desc_info)
-{
-	struct rtw89_ppdu_sts_info *ppdu_sts = &rtwdev->ppdu_sts;
-	u8 band = desc_info->bb_sel ? RTW89_PHY_1 : RTW89_PHY_0;
-	struct ieee80211_rx_status *rx_status;
-	struct sk_buff *skb_ppdu, *tmp;
-
-	skb_queue_walk_safe(&ppdu_sts->rx_queue[band], skb_ppdu, tmp) {
-		skb_unlink(skb_ppdu, &ppdu_sts->rx_queue[band]);
-		rx_status = IEEE80211_SKB_RXCB(skb_ppdu);
-		rtw89_core_rx_to_mac80211(rtwdev, NULL, desc_info, skb_ppdu, rx_status);
-	}
-}
-
 void rtw89_core_rx(struct rtw89_dev *rtwdev,
 		   struct rtw89_rx_desc_info *desc_info,
 		   struct sk_buff *skb)
@@ -2546,33 +3006,58 @@ void rtw89_core_rx(struct rtw89_dev *rtwdev,
 	u8 ppdu_cnt = desc_info->ppdu_cnt;
 	u8 band = desc_info->bb_sel ? RTW89_PHY_1 : RTW89_PHY_0;
 
+	trace_rtw89_core_rx(rtwdev, desc_info);
+
 	if (desc_info->pkt_type != RTW89_CORE_RX_TYPE_WIFI) {
 		rtw89_core_rx_process_report(rtwdev, desc_info, skb);
 		return;
 	}
 
 	if (ppdu_sts->curr_rx_ppdu_cnt[band] != ppdu_cnt) {
-		rtw89_core_flush_ppdu_rx_queue(rtwdev, desc_info);
+		/* a new PPDU comes, so frames of earlier ones, including the
+		 * slot of ppdu_cnt wrapping around, can't wait any longer.
+		 */
+		rtw89_core_ppdu_slot_release(rtwdev, band, ppdu_cnt, NULL, NULL,
+					     &ppdu_sts->stats.evicted);
+		rtw89_core_ppdu_slot_flush_older(rtwdev, band, ppdu_cnt);
 		ppdu_sts->curr_rx_ppdu_cnt[band] = ppdu_cnt;
 	}
 
 	rx_status = IEEE80211_SKB_RXCB(skb);
 	memset(rx_status, 0, sizeof(*rx_status));
 	rtw89_core_update_rx_status(rtwdev, desc_info, rx_status);
+	rtw89_core_stats_sta_rx_airtime(rtwdev, desc_info, rx_status, skb);
 	if (desc_info->long_rxdesc &&
-	    BIT(desc_info->frame_type) & PPDU_FILTER_BITMAP)
-		skb_queue_tail(&ppdu_sts->rx_queue[band], skb);
+	    BIT(desc_info->frame_type) & PPDU_FILTER_BITMAP &&
+	    READ_ONCE(ppdu_sts->enabled[band]))
+		rtw89_core_ppdu_slot_hold(rtwdev, band, desc_info, skb);
 	else
 		rtw89_core_rx_to_mac80211(rtwdev, NULL, desc_info, skb, rx_status);
 }
 EXPORT_SYMBOL(rtw89_core_rx);
 
+void rtw89_core_napi_rx_flush(struct rtw89_dev *rtwdev)
+{
+	struct sk_buff *skb, *tmp;
+
+	rtw89_core_ppdu_sts_expire(rtwdev);
+
+	/* GRO is kept rather than netif_receive_skb_list() for TCP */
+	list_for_each_entry_safe(skb, tmp, &rtwdev->napi_rx_list, list) {
+		skb_list_del_init(skb);
+		napi_gro_receive(&rtwdev->napi, skb);
+	}
+}
+EXPORT_SYMBOL(rtw89_core_napi_rx_flush);
+
 void rtw89_core_napi_start(struct rtw89_dev *rtwdev)
 {
 	if (test_and_set_bit(RTW89_FLAG_NAPI_RUNNING, rtwdev->flags))
 		return;
 
 	napi_enable(&rtwdev->napi);
+	if (rtwdev->hci.ops->napi_poll_tx)
+		napi_enable(&rtwdev->napi_tx);
 }
 EXPORT_SYMBOL(rtw89_core_napi_start);
 
@@ -2581,20 +3066,66 @@ void rtw89_core_napi_stop(struct rtw89_dev *rtwdev)
 	if (!test_and_clear_bit(RTW89_FLAG_NAPI_RUNNING, rtwdev->flags))
 		return;
 
+	if (rtwdev->hci.ops->napi_poll_tx) {
+		napi_synchronize(&rtwdev->napi_tx);
+		napi_disable(&rtwdev->napi_tx);
+	}
 	napi_synchronize(&rtwdev->napi);
 	napi_disable(&rtwdev->napi);
+
+	hrtimer_cancel(&rtwdev->ppdu_sts.hold_timer);
+	rtw89_core_ppdu_sts_purge(rtwdev);
 }
 EXPORT_SYMBOL(rtw89_core_napi_stop);
 
-void rtw89_core_napi_init(struct rtw89_dev *rtwdev)
+void rtw89_core_napi_synchronize(struct rtw89_dev *rtwdev)
+{
+	if (!test_bit(RTW89_FLAG_NAPI_RUNNING, rtwdev->flags))
+		return;
+
+	if (rtwdev->hci.ops->napi_poll_tx)
+		napi_synchronize(&rtwdev->napi_tx);
+	napi_synchronize(&rtwdev->napi);
+}
+EXPORT_SYMBOL(rtw89_core_napi_synchronize);
+
+/* poll RX and TX release reports that arrived while interrupts were off */
+void rtw89_core_napi_schedule_all(struct rtw89_dev *rtwdev)
+{
+	local_bh_disable();
+	if (rtwdev->hci.ops->napi_poll_tx)
+		napi_schedule(&rtwdev->napi_tx);
+	napi_schedule(&rtwdev->napi);
+	local_bh_enable();
+}
+
+static void rtw89_core_napi_add(struct rtw89_dev *rtwdev,
+				struct napi_struct *napi,
+				int (*poll)(struct napi_struct *, int))
 {
-	init_dummy_netdev(&rtwdev->netdev);
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 1, 0)
-	netif_napi_add(&rtwdev->netdev, &rtwdev->napi,
-		       rtwdev->hci.ops->napi_poll);
+	netif_napi_add(&rtwdev->netdev, napi, poll);
 #else
-	netif_napi_add(&rtwdev->netdev, &rtwdev->napi,
-		       rtwdev->hci.ops->napi_poll, 0);
+	netif_napi_add(&rtwdev->netdev, napi, poll, 0);
+#endif
+}
+
+void rtw89_core_napi_init(struct rtw89_dev *rtwdev)
+{
+	init_dummy_netdev(&rtwdev->netdev);
+	INIT_LIST_HEAD(&rtwdev->napi_rx_list);
+	rtw89_core_napi_add(rtwdev, &rtwdev->napi, rtwdev->hci.ops->napi_poll);
+
+	if (!rtwdev->hci.ops->napi_poll_tx)
+		return;
+
+	rtw89_core_napi_add(rtwdev, &rtwdev->napi_tx,
+			    rtwdev->hci.ops->napi_poll_tx);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 12, 0)
+	/* both are scheduled by one interrupt thread, so run them in own
+	 * kthreads to be able to go to different CPUs.
+	 */
+	dev_set_threaded(&rtwdev->netdev, true);
 #endif
 }
 EXPORT_SYMBOL(rtw89_core_napi_init);
@@ -2602,6 +3133,8 @@ EXPORT_SYMBOL(rtw89_core_napi_init);
 void rtw89_core_napi_deinit(struct rtw89_dev *rtwdev)
 {
 	rtw89_core_napi_stop(rtwdev);
+	if (rtwdev->hci.ops->napi_poll_tx)
+		netif_napi_del(&rtwdev->napi_tx);
 	netif_napi_del(&rtwdev->napi);
 }
 EXPORT_SYMBOL(rtw89_core_napi_deinit);
@@ -2779,52 +3312,106 @@ static void rtw89_core_txq_push(struct rtw89_dev *rtwdev,
 	}
 out:
 	rcu_read_unlock();
+
+	if (i) {
+		rtwtxq->push_cnt++;
+		rtwtxq->push_frames += i;
+	}
 }
 
-static u32 rtw89_check_and_reclaim_tx_resource(struct rtw89_dev *rtwdev, u8 tid)
+static u8 rtw89_core_txq_ch_dma(struct rtw89_dev *rtwdev,
+				struct ieee80211_txq *txq)
 {
-	u8 qsel, ch_dma;
+	struct rtw89_vif *rtwvif = (struct rtw89_vif *)txq->vif->drv_priv;
+	u8 qsel;
 
-	qsel = rtw89_core_get_qsel(rtwdev, tid);
-	ch_dma = rtw89_core_get_ch_dma(rtwdev, qsel);
+	qsel = rtw89_core_get_qsel_band(rtwdev, txq->tid, rtwvif->mac_idx);
+
+	return rtw89_core_get_ch_dma(rtwdev, qsel);
+}
+
+static u32 rtw89_check_and_reclaim_tx_resource(struct rtw89_dev *rtwdev,
+					       struct ieee80211_txq *txq)
+{
+	u8 ch_dma = rtw89_core_txq_ch_dma(rtwdev, txq);
 
 	return rtw89_hci_check_and_reclaim_tx_resource(rtwdev, ch_dma);
 }
 
+#define RTW89_TXQ_HOLD_MAX_US 1000
+#define RTW89_TXQ_RESCHED_US 500
+
+static void rtw89_core_txq_reinvoke_at(ktime_t *reinvoke, ktime_t expires)
+{
+	if (!*reinvoke || ktime_before(expires, *reinvoke))
+		*reinvoke = expires;
+}
+
+/* Hold a lone frame for about the time the rest of an aggregate takes to
+ * arrive. Holding isn't worth it if frames come in more sparsely than
+ * the cap, since the aggregate would hardly grow.
+ */
+static u32 rtw89_core_txq_hold_us(struct rtw89_sta *rtwsta,
+				  struct rtw89_txq *rtwtxq)
+{
+	unsigned long ia_us = ewma_txq_ia_read(&rtwtxq->ia_us);
+
+	if (rtwsta->max_agg_wait <= 0 || !ia_us ||
+	    ia_us > RTW89_TXQ_HOLD_MAX_US)
+		return 0;
+
+	return min_t(unsigned long, ia_us * rtwsta->max_agg_wait,
+		     RTW89_TXQ_HOLD_MAX_US);
+}
+
 static bool rtw89_core_txq_agg_wait(struct rtw89_dev *rtwdev,
 				    struct ieee80211_txq *txq,
 				    unsigned long *frame_cnt,
-				    bool *sched_txq, bool *reinvoke)
+				    bool *sched_txq, ktime_t *reinvoke)
 {
 	struct rtw89_txq *rtwtxq = (struct rtw89_txq *)txq->drv_priv;
 	struct ieee80211_sta *sta = txq->sta;
 	struct rtw89_sta *rtwsta = sta ? (struct rtw89_sta *)sta->drv_priv : NULL;
+	ktime_t now;
+	u32 hold_us;
 
-	if (!sta || rtwsta->max_agg_wait <= 0)
+	if (!sta)
 		return false;
 
 	if (rtwdev->stats.tx_tfc_lv <= RTW89_TFC_MID)
-		return false;
+		goto no_hold;
+
+	hold_us = rtw89_core_txq_hold_us(rtwsta, rtwtxq);
+	if (!hold_us)
+		goto no_hold;
+
+	now = ktime_get();
 
 	if (*frame_cnt > 1) {
 		*frame_cnt -= 1;
 		*sched_txq = true;
-		*reinvoke = true;
-		rtwtxq->wait_cnt = 1;
+		rtwtxq->hold_until = ktime_add_us(now, hold_us);
+		rtw89_core_txq_reinvoke_at(reinvoke, rtwtxq->hold_until);
 		return false;
 	}
 
-	if (*frame_cnt == 1 && rtwtxq->wait_cnt < rtwsta->max_agg_wait) {
-		*reinvoke = true;
-		rtwtxq->wait_cnt++;
-		return true;
+	if (*frame_cnt == 1) {
+		if (!rtwtxq->hold_until)
+			rtwtxq->hold_until = ktime_add_us(now, hold_us);
+
+		if (ktime_before(now, rtwtxq->hold_until)) {
+			rtw89_core_txq_reinvoke_at(reinvoke, rtwtxq->hold_until);
+			return true;
+		}
 	}
 
-	rtwtxq->wait_cnt = 0;
+no_hold:
+	rtwtxq->hold_until = 0;
 	return false;
 }
 
-static void rtw89_core_txq_schedule(struct rtw89_dev *rtwdev, u8 ac, bool *reinvoke)
+static void rtw89_core_txq_schedule(struct rtw89_dev *rtwdev, u8 ac,
+				    unsigned long *kick_map, ktime_t *reinvoke)
 {
 	struct ieee80211_hw *hw = rtwdev->hw;
 	struct ieee80211_txq *txq;
@@ -2834,6 +3421,7 @@ static void rtw89_core_txq_schedule(struct rtw89_dev *rtwdev, u8 ac, bool *reinv
 	unsigned long byte_cnt;
 	u32 tx_resource;
 	bool sched_txq;
+	bool stalled;
 
 	ieee80211_txq_schedule_start(hw, ac);
 	while ((txq = ieee80211_next_txq(hw, ac))) {
@@ -2844,27 +3432,104 @@ static void rtw89_core_txq_schedule(struct rtw89_dev *rtwdev, u8 ac, bool *reinv
 			ieee80211_return_txq(hw, txq, true);
 			continue;
 		}
-		tx_resource = rtw89_check_and_reclaim_tx_resource(rtwdev, txq->tid);
+		tx_resource = rtw89_check_and_reclaim_tx_resource(rtwdev, txq);
 		sched_txq = false;
 
 		ieee80211_txq_get_depth(txq, &frame_cnt, &byte_cnt);
 		if (rtw89_core_txq_agg_wait(rtwdev, txq, &frame_cnt, &sched_txq, reinvoke)) {
+			rtw89_core_txq_set_stalled(rtwdev, rtwtxq, false);
 			ieee80211_return_txq(hw, txq, true);
 			continue;
 		}
+		stalled = frame_cnt > tx_resource;
 		frame_cnt = min_t(unsigned long, frame_cnt, tx_resource);
 		rtw89_core_txq_push(rtwdev, rtwtxq, frame_cnt, byte_cnt);
+		rtw89_core_txq_set_stalled(rtwdev, rtwtxq, stalled);
 		ieee80211_return_txq(hw, txq, sched_txq);
+		/* defer doorbell to the end of this round like xmit_more */
 		if (frame_cnt != 0)
-			rtw89_core_tx_kick_off(rtwdev, rtw89_core_get_qsel(rtwdev, txq->tid));
+			set_bit(rtw89_core_txq_ch_dma(rtwdev, txq), kick_map);
 
 		/* bound of tx_resource could get stuck due to burst traffic */
 		if (frame_cnt == tx_resource)
-			*reinvoke = true;
+			rtw89_core_txq_reinvoke_at(reinvoke,
+						   ktime_add_us(ktime_get(),
+								RTW89_TXQ_RESCHED_US));
 	}
 	ieee80211_txq_schedule_end(hw, ac);
 }
 
+/* Frames can be pushed in context of wake_tx_queue unless the scheduler
+ * may hold them back to aggregate, which only happens under heavy TX.
+ */
+static bool rtw89_core_txq_can_direct(struct rtw89_dev *rtwdev,
+				      struct ieee80211_txq *txq)
+{
+	struct rtw89_txq *rtwtxq = (struct rtw89_txq *)txq->drv_priv;
+
+	if (rtwdev->stats.tx_tfc_lv > RTW89_TFC_MID)
+		return false;
+
+	/* no MMIO reclaim while switching PS mode */
+	if (rtwdev->hci.paused)
+		return false;
+
+	if (rtwtxq->hold_until)
+		return false;
+
+	if (work_pending(&rtwdev->txq_work) ||
+	    hrtimer_active(&rtwdev->txq_reinvoke_timer))
+		return false;
+
+	return true;
+}
+
+void rtw89_core_txq_wake(struct rtw89_dev *rtwdev, struct ieee80211_txq *txq)
+{
+	struct rtw89_txq_path_stats *path_stats = &rtwdev->txq_path_stats;
+	struct rtw89_txq *rtwtxq = (struct rtw89_txq *)txq->drv_priv;
+	DECLARE_BITMAP(kick_map, RTW89_TXCH_NUM) = {};
+	ktime_t now = ktime_get();
+	ktime_t reinvoke = 0;
+	unsigned int txch;
+	s64 delta_us;
+
+	/* lockless on purpose, this only steers the aggregation hold */
+	if (rtwtxq->last_wake) {
+		delta_us = ktime_us_delta(now, rtwtxq->last_wake);
+		ewma_txq_ia_add(&rtwtxq->ia_us,
+				clamp_t(s64, delta_us, 1, USEC_PER_SEC));
+	}
+	rtwtxq->last_wake = now;
+
+	ieee80211_schedule_txq(rtwdev->hw, txq);
+
+	/* rounds skip the txq until TX release gives airtime back */
+	if (!ieee80211_txq_airtime_check(rtwdev->hw, txq))
+		rtw89_core_txq_set_stalled(rtwdev, rtwtxq, true);
+
+	/* another CPU or txq_work owns the round of this AC, leave it there */
+	if (!rtw89_core_txq_can_direct(rtwdev, txq) ||
+	    !spin_trylock_bh(&rtwdev->txq_sched_lock[txq->ac])) {
+		atomic64_inc(&path_stats->deferred);
+		queue_work(rtwdev->txq_wq, &rtwdev->txq_work);
+		return;
+	}
+
+	atomic64_inc(&path_stats->direct);
+	rtw89_core_txq_schedule(rtwdev, txq->ac, kick_map, &reinvoke);
+	spin_unlock_bh(&rtwdev->txq_sched_lock[txq->ac]);
+
+	for_each_set_bit(txch, kick_map, RTW89_TXCH_NUM)
+		rtw89_hci_tx_kick_off(rtwdev, txch);
+
+	/* out of TX resource, or frames held to aggregate */
+	if (reinvoke) {
+		atomic64_inc(&path_stats->direct_fallback);
+		queue_work(rtwdev->txq_wq, &rtwdev->txq_work);
+	}
+}
+
 static void rtw89_ips_work(struct work_struct *work)
 {
 	struct rtw89_dev *rtwdev = container_of(work, struct rtw89_dev,
@@ -2877,24 +3542,37 @@ static void rtw89_ips_work(struct work_struct *work)
 static void rtw89_core_txq_work(struct work_struct *w)
 {
 	struct rtw89_dev *rtwdev = container_of(w, struct rtw89_dev, txq_work);
-	bool reinvoke = false;
+	DECLARE_BITMAP(kick_map, RTW89_TXCH_NUM) = {};
+	ktime_t reinvoke = 0;
+	unsigned int txch;
 	u8 ac;
 
-	for (ac = 0; ac < IEEE80211_NUM_ACS; ac++)
-		rtw89_core_txq_schedule(rtwdev, ac, &reinvoke);
+	atomic64_inc(&rtwdev->txq_path_stats.work);
+
+	for (ac = 0; ac < IEEE80211_NUM_ACS; ac++) {
+		spin_lock_bh(&rtwdev->txq_sched_lock[ac]);
+		rtw89_core_txq_schedule(rtwdev, ac, kick_map, &reinvoke);
+		spin_unlock_bh(&rtwdev->txq_sched_lock[ac]);
+	}
+
+	for_each_set_bit(txch, kick_map, RTW89_TXCH_NUM)
+		rtw89_hci_tx_kick_off(rtwdev, txch);
 
 	if (reinvoke) {
-		/* reinvoke to process the last frame */
-		mod_delayed_work(rtwdev->txq_wq, &rtwdev->txq_reinvoke_work, 1);
+		/* reinvoke to process the held frames */
+		hrtimer_start(&rtwdev->txq_reinvoke_timer, reinvoke,
+			      HRTIMER_MODE_ABS);
 	}
 }
 
-static void rtw89_core_txq_reinvoke_work(struct work_struct *w)
+static enum hrtimer_restart rtw89_core_txq_reinvoke_timer(struct hrtimer *timer)
 {
-	struct rtw89_dev *rtwdev = container_of(w, struct rtw89_dev,
-						txq_reinvoke_work.work);
+	struct rtw89_dev *rtwdev = container_of(timer, struct rtw89_dev,
+						txq_reinvoke_timer);
 
 	queue_work(rtwdev->txq_wq, &rtwdev->txq_work);
+
+	return HRTIMER_NORESTART;
 }
 
 static void rtw89_forbid_ba_work(struct work_struct *w)
@@ -3117,12 +3795,45 @@ static enum rtw89_tfc_lv rtw89_get_traffic_level(struct rtw89_dev *rtwdev,
 	return RTW89_TFC_ULTRA_LOW;
 }
 
+static void rtw89_traffic_stats_fold(struct rtw89_traffic_stats *stats)
+{
+	struct rtw89_traffic_pcpu sum = {};
+	const struct rtw89_traffic_pcpu *pcpu;
+	u64 tx_unicast, rx_unicast, tx_cnt, rx_cnt;
+	unsigned int start;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		pcpu = per_cpu_ptr(stats->pcpu, cpu);
+		do {
+			start = u64_stats_fetch_begin(&pcpu->syncp);
+			tx_unicast = pcpu->tx_unicast;
+			rx_unicast = pcpu->rx_unicast;
+			tx_cnt = pcpu->tx_cnt;
+			rx_cnt = pcpu->rx_cnt;
+		} while (u64_stats_fetch_retry(&pcpu->syncp, start));
+
+		sum.tx_unicast += tx_unicast;
+		sum.rx_unicast += rx_unicast;
+		sum.tx_cnt += tx_cnt;
+		sum.rx_cnt += rx_cnt;
+	}
+
+	stats->tx_unicast = sum.tx_unicast - stats->folded.tx_unicast;
+	stats->rx_unicast = sum.rx_unicast - stats->folded.rx_unicast;
+	stats->tx_cnt = sum.tx_cnt - stats->folded.tx_cnt;
+	stats->rx_cnt = sum.rx_cnt - stats->folded.rx_cnt;
+	stats->folded = sum;
+}
+
 static bool rtw89_traffic_stats_calc(struct rtw89_dev *rtwdev,
 				     struct rtw89_traffic_stats *stats)
 {
 	enum rtw89_tfc_lv tx_tfc_lv = stats->tx_tfc_lv;
 	enum rtw89_tfc_lv rx_tfc_lv = stats->rx_tfc_lv;
 
+	rtw89_traffic_stats_fold(stats);
+
 	stats->tx_throughput_raw = (u32)(stats->tx_unicast >> RTW89_TP_SHIFT);
 	stats->rx_throughput_raw = (u32)(stats->rx_unicast >> RTW89_TP_SHIFT);
 
@@ -3140,10 +3851,6 @@ static bool rtw89_traffic_stats_calc(struct rtw89_dev *rtwdev,
 	stats->rx_avg_len = stats->rx_cnt ?
 			    DIV_ROUND_DOWN_ULL(stats->rx_unicast, stats->rx_cnt) : 0;
 
-	stats->tx_unicast = 0;
-	stats->rx_unicast = 0;
-	stats->tx_cnt = 0;
-	stats->rx_cnt = 0;
 	stats->rx_tf_periodic = stats->rx_tf_acc;
 	stats->rx_tf_acc = 0;
 
@@ -3153,18 +3860,14 @@ static bool rtw89_traffic_stats_calc(struct rtw89_dev *rtwdev,
 	return false;
 }
 
-static bool rtw89_traffic_stats_track(struct rtw89_dev *rtwdev)
+static void rtw89_traffic_stats_track_vif(struct rtw89_dev *rtwdev)
 {
 	struct rtw89_vif *rtwvif;
-	bool tfc_changed;
 
-	tfc_changed = rtw89_traffic_stats_calc(rtwdev, &rtwdev->stats);
 	rtw89_for_each_rtwvif(rtwdev, rtwvif) {
 		rtw89_traffic_stats_calc(rtwdev, &rtwvif->stats);
 		rtw89_fw_h2c_tp_offload(rtwdev, rtwvif);
 	}
-
-	return tfc_changed;
 }
 
 static void rtw89_vif_enter_lps(struct rtw89_dev *rtwdev, struct rtw89_vif *rtwvif)
@@ -3211,15 +3914,139 @@ void rtw89_core_update_p2p_ps(struct rtw89_dev *rtwdev, struct ieee80211_vif *vi
 		rtw89_process_p2p_ps(rtwdev, vif);
 }
 
-void rtw89_traffic_stats_init(struct rtw89_dev *rtwdev,
-			      struct rtw89_traffic_stats *stats)
+int rtw89_traffic_stats_init(struct rtw89_dev *rtwdev,
+			     struct rtw89_traffic_stats *stats)
 {
+	struct rtw89_traffic_pcpu *pcpu;
+	int cpu;
+
+	/* mac80211 adds interfaces again on restart with drv_priv kept */
+	if (!stats->pcpu) {
+		stats->pcpu = alloc_percpu(struct rtw89_traffic_pcpu);
+		if (!stats->pcpu)
+			return -ENOMEM;
+	}
+
+	for_each_possible_cpu(cpu) {
+		pcpu = per_cpu_ptr(stats->pcpu, cpu);
+		memset(pcpu, 0, sizeof(*pcpu));
+		u64_stats_init(&pcpu->syncp);
+	}
+
+	memset(&stats->folded, 0, sizeof(stats->folded));
 	stats->tx_unicast = 0;
 	stats->rx_unicast = 0;
 	stats->tx_cnt = 0;
 	stats->rx_cnt = 0;
 	ewma_tp_init(&stats->tx_ewma_tp);
 	ewma_tp_init(&stats->rx_ewma_tp);
+
+	return 0;
+}
+
+void rtw89_traffic_stats_deinit(struct rtw89_traffic_stats *stats)
+{
+	free_percpu(stats->pcpu);
+	stats->pcpu = NULL;
+}
+
+static void rtw89_core_tas_track(struct rtw89_dev *rtwdev)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 11, 0)
+	rtw89_tas_track(rtwdev);
+#endif
+}
+
+static void rtw89_core_lps_track(struct rtw89_dev *rtwdev)
+{
+	if (rtwdev->lps_enabled && !rtwdev->btc.lps)
+		rtw89_enter_lps_track(rtwdev);
+}
+
+static void (* const rtw89_track_stages[RTW89_TRACK_STAGE_NUM])(struct rtw89_dev *rtwdev) = {
+	[RTW89_TRACK_BF_MONITOR] = rtw89_mac_bf_monitor_track,
+	[RTW89_TRACK_PHY_STAT] = rtw89_phy_stat_track,
+	[RTW89_TRACK_ENV_MONITOR] = rtw89_phy_env_monitor_track,
+	[RTW89_TRACK_DIG] = rtw89_phy_dig,
+	[RTW89_TRACK_RFK] = rtw89_core_rfk_track,
+	[RTW89_TRACK_RA] = rtw89_phy_ra_update,
+	[RTW89_TRACK_CFO] = rtw89_phy_cfo_track,
+	[RTW89_TRACK_TX_PATH_DIV] = rtw89_phy_tx_path_div_track,
+	[RTW89_TRACK_ANTDIV] = rtw89_phy_antdiv_track,
+	[RTW89_TRACK_UL_TB] = rtw89_phy_ul_tb_ctrl_track,
+	[RTW89_TRACK_EDCCA] = rtw89_phy_edcca_track,
+	[RTW89_TRACK_TAS] = rtw89_core_tas_track,
+	[RTW89_TRACK_CHANCTX] = rtw89_chanctx_track,
+	[RTW89_TRACK_LPS] = rtw89_core_lps_track,
+};
+
+/* Stages of a group share results of the same round, e.g. DIG works on
+ * statistics gathered by PHY status and env monitor, so a group runs under
+ * one hold of rtwdev->mutex to keep channel and stations unchanged for it.
+ */
+static const struct rtw89_track_group {
+	enum rtw89_track_stage first;
+	enum rtw89_track_stage last;
+} rtw89_track_groups[] = {
+	{RTW89_TRACK_BF_MONITOR, RTW89_TRACK_BF_MONITOR},
+	{RTW89_TRACK_PHY_STAT, RTW89_TRACK_DIG},
+	{RTW89_TRACK_RFK, RTW89_TRACK_CFO},
+	{RTW89_TRACK_TX_PATH_DIV, RTW89_TRACK_TX_PATH_DIV},
+	{RTW89_TRACK_ANTDIV, RTW89_TRACK_ANTDIV},
+	{RTW89_TRACK_UL_TB, RTW89_TRACK_UL_TB},
+	{RTW89_TRACK_EDCCA, RTW89_TRACK_EDCCA},
+	{RTW89_TRACK_TAS, RTW89_TRACK_TAS},
+	{RTW89_TRACK_CHANCTX, RTW89_TRACK_CHANCTX},
+	{RTW89_TRACK_LPS, RTW89_TRACK_LPS},
+};
+
+static void rtw89_track_stage_done(struct rtw89_dev *rtwdev,
+				   enum rtw89_track_stage stage, ktime_t start)
+{
+	struct rtw89_track_stage_stats *stats = &rtwdev->track_stats[stage];
+	u32 us = ktime_us_delta(ktime_get(), start);
+
+	stats->cnt++;
+	stats->total_us += us;
+	stats->last_us = us;
+	stats->max_us = max(stats->max_us, us);
+}
+
+static bool rtw89_track_allowed(struct rtw89_dev *rtwdev)
+{
+	return !test_bit(RTW89_FLAG_FORBIDDEN_TRACK_WROK, rtwdev->flags) &&
+	       test_bit(RTW89_FLAG_RUNNING, rtwdev->flags) &&
+	       !rtwdev->scanning;
+}
+
+/* Each group takes rtwdev->mutex by itself, so mac80211 ops wait for one
+ * group at most instead of the whole pipeline.
+ */
+static bool rtw89_track_group_run(struct rtw89_dev *rtwdev,
+				  const struct rtw89_track_group *group)
+{
+	enum rtw89_track_stage stage;
+	bool ret = false;
+	ktime_t start;
+
+	mutex_lock(&rtwdev->mutex);
+
+	if (!rtw89_track_allowed(rtwdev))
+		goto out;
+
+	rtw89_leave_lps(rtwdev);
+
+	for (stage = group->first; stage <= group->last; stage++) {
+		start = ktime_get();
+		rtw89_track_stages[stage](rtwdev);
+		rtw89_track_stage_done(rtwdev, stage, start);
+	}
+	ret = true;
+
+out:
+	mutex_unlock(&rtwdev->mutex);
+
+	return ret;
 }
 
 static void rtw89_track_work(struct work_struct *work)
@@ -3227,10 +4054,20 @@ static void rtw89_track_work(struct work_struct *work)
 	struct rtw89_dev *rtwdev = container_of(work, struct rtw89_dev,
 						track_work.work);
 	bool tfc_changed;
+	ktime_t start;
+	int i;
 
-	if (test_bit(RTW89_FLAG_FORBIDDEN_TRACK_WROK, rtwdev->flags))
+	if (test_bit(RTW89_FLAG_FORBIDDEN_TRACK_WROK, rtwdev->flags) ||
+	    !test_bit(RTW89_FLAG_RUNNING, rtwdev->flags))
 		return;
 
+	/* counters are accumulated by TX/RX paths locklessly, and only this
+	 * work consumes them, so it doesn't need the mutex.
+	 */
+	start = ktime_get();
+	tfc_changed = rtw89_traffic_stats_calc(rtwdev, &rtwdev->stats);
+	rtw89_track_stage_done(rtwdev, RTW89_TRACK_TRAFFIC, start);
+
 	mutex_lock(&rtwdev->mutex);
 
 	if (!test_bit(RTW89_FLAG_RUNNING, rtwdev->flags))
@@ -3239,7 +4076,8 @@ static void rtw89_track_work(struct work_struct *work)
 	ieee80211_queue_delayed_work(rtwdev->hw, &rtwdev->track_work,
 				     RTW89_TRACK_WORK_PERIOD);
 
-	tfc_changed = rtw89_traffic_stats_track(rtwdev);
+	start = ktime_get();
+	rtw89_traffic_stats_track_vif(rtwdev);
 	if (rtwdev->scanning)
 		goto out;
 
@@ -3249,24 +4087,15 @@ static void rtw89_track_work(struct work_struct *work)
 		rtw89_hci_recalc_int_mit(rtwdev);
 		rtw89_btc_ntfy_wl_sta(rtwdev);
 	}
-	rtw89_mac_bf_monitor_track(rtwdev);
-	rtw89_phy_stat_track(rtwdev);
-	rtw89_phy_env_monitor_track(rtwdev);
-	rtw89_phy_dig(rtwdev);
-	rtw89_core_rfk_track(rtwdev);
-	rtw89_phy_ra_update(rtwdev);
-	rtw89_phy_cfo_track(rtwdev);
-	rtw89_phy_tx_path_div_track(rtwdev);
-	rtw89_phy_antdiv_track(rtwdev);
-	rtw89_phy_ul_tb_ctrl_track(rtwdev);
-	rtw89_phy_edcca_track(rtwdev);
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 11, 0)
-	rtw89_tas_track(rtwdev);
-#endif
-	rtw89_chanctx_track(rtwdev);
+	rtw89_track_stage_done(rtwdev, RTW89_TRACK_TRAFFIC_VIF, start);
 
-	if (rtwdev->lps_enabled && !rtwdev->btc.lps)
-		rtw89_enter_lps_track(rtwdev);
+	mutex_unlock(&rtwdev->mutex);
+
+	for (i = 0; i < ARRAY_SIZE(rtw89_track_groups); i++)
+		if (!rtw89_track_group_run(rtwdev, &rtw89_track_groups[i]))
+			return;
+
+	return;
 
 out:
 	mutex_unlock(&rtwdev->mutex);
@@ -3488,6 +4317,8 @@ int rtw89_core_sta_add(struct rtw89_dev *rtwdev,
 		rtw89_queue_chanctx_change(rtwdev, RTW89_CHANCTX_REMOTE_STA_CHANGE);
 	}
 
+	rcu_assign_pointer(rtwdev->sta_on_macid[rtwsta->mac_id], rtwsta);
+
 	return 0;
 }
 
@@ -3613,8 +4444,10 @@ int rtw89_core_sta_assoc(struct rtw89_dev *rtwdev,
 		struct ieee80211_bss_conf *bss_conf = &vif->bss_conf;
 
 		if (bss_conf->he_support &&
-		    !(bss_conf->he_oper.params & IEEE80211_HE_OPERATION_ER_SU_DISABLE))
+		    !(bss_conf->he_oper.params & IEEE80211_HE_OPERATION_ER_SU_DISABLE)) {
 			rtwsta->er_cap = true;
+			rtw89_core_tx_tmpl_invalidate(rtwdev);
+		}
 #endif
 
 		rtw89_btc_ntfy_role_info(rtwdev, rtwvif, rtwsta,
@@ -3641,6 +4474,16 @@ int rtw89_core_sta_remove(struct rtw89_dev *rtwdev,
 	struct rtw89_vif *rtwvif = (struct rtw89_vif *)vif->drv_priv;
 	struct rtw89_sta *rtwsta = (struct rtw89_sta *)sta->drv_priv;
 	int ret;
+	int i;
+
+	if (rcu_access_pointer(rtwdev->sta_on_macid[rtwsta->mac_id]) == rtwsta) {
+		RCU_INIT_POINTER(rtwdev->sta_on_macid[rtwsta->mac_id], NULL);
+		/* mac80211 frees sta right after this callback */
+		synchronize_rcu();
+	}
+
+	for (i = 0; i < ARRAY_SIZE(sta->txq); i++)
+		rtw89_core_txq_deinit(rtwdev, sta->txq[i]);
 
 	if (vif->type == NL80211_IFTYPE_STATION && !sta->tdls) {
 		rtw89_reg_6ghz_power_recalc(rtwdev, rtwvif, false);
@@ -4145,12 +4988,21 @@ static void rtw89_core_clr_supported_band(struct rtw89_dev *rtwdev)
 
 static void rtw89_core_ppdu_sts_init(struct rtw89_dev *rtwdev)
 {
-	int i;
+	struct rtw89_ppdu_sts_info *ppdu_sts = &rtwdev->ppdu_sts;
+	int i, j;
 
 	for (i = 0; i < RTW89_PHY_MAX; i++)
-		skb_queue_head_init(&rtwdev->ppdu_sts.rx_queue[i]);
+		for (j = 0; j < RTW89_MAX_PPDU_CNT; j++)
+			__skb_queue_head_init(&ppdu_sts->slots[i][j].frames);
 	for (i = 0; i < RTW89_PHY_MAX; i++)
-		rtwdev->ppdu_sts.curr_rx_ppdu_cnt[i] = U8_MAX;
+		ppdu_sts->curr_rx_ppdu_cnt[i] = U8_MAX;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 13, 0)
+	hrtimer_setup(&ppdu_sts->hold_timer, rtw89_core_ppdu_sts_hold_timer,
+		      CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+#else
+	hrtimer_init(&ppdu_sts->hold_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	ppdu_sts->hold_timer.function = rtw89_core_ppdu_sts_hold_timer;
+#endif
 }
 
 void rtw89_core_update_beacon_work(struct work_struct *work)
@@ -4316,7 +5168,7 @@ void rtw89_core_stop(struct rtw89_dev *rtwdev)
 	cancel_work_sync(&btc->arp_notify_work);
 	cancel_work_sync(&btc->dhcp_notify_work);
 	cancel_work_sync(&btc->icmp_notify_work);
-	cancel_delayed_work_sync(&rtwdev->txq_reinvoke_work);
+	hrtimer_cancel(&rtwdev->txq_reinvoke_timer);
 	cancel_delayed_work_sync(&rtwdev->track_work);
 	cancel_delayed_work_sync(&rtwdev->chanctx_work);
 	cancel_delayed_work_sync(&rtwdev->coex_act1_work);
@@ -4329,7 +5181,8 @@ void rtw89_core_stop(struct rtw89_dev *rtwdev)
 	mutex_lock(&rtwdev->mutex);
 
 	rtw89_btc_ntfy_poweroff(rtwdev);
-	rtw89_hci_flush_queues(rtwdev, BIT(rtwdev->hw->queues) - 1, true);
+	rtw89_hci_flush_queues(rtwdev, BIT(rtwdev->hw->queues) - 1,
+			       RTW89_FLUSH_DROP);
 	rtw89_mac_flush_txq(rtwdev, BIT(rtwdev->hw->queues) - 1, true);
 	rtw89_hci_stop(rtwdev);
 	rtw89_hci_deinit(rtwdev);
@@ -4337,12 +5190,44 @@ void rtw89_core_stop(struct rtw89_dev *rtwdev)
 	rtw89_hci_reset(rtwdev);
 }
 
+static void rtw89_core_reg_shadow_init(struct rtw89_dev *rtwdev)
+{
+	const struct rtw89_reg_shadow_cfg *cfg = rtwdev->chip->reg_shadow;
+	const struct rtw89_phy_gen_def *phy = rtwdev->chip->phy_def;
+	struct rtw89_reg_shadow *shadow = &rtwdev->reg_shadow;
+	u32 addr;
+	int i;
+
+	shadow->num = 0;
+	rtw89_reg_shadow_invalidate(rtwdev);
+
+	if (!cfg)
+		return;
+
+	for (i = 0; i < cfg->n_phy_regs; i++) {
+		addr = cfg->phy_regs[i] + phy->cr_base;
+		if (rtw89_reg_shadow_find(rtwdev, addr) >= 0)
+			continue;
+
+		if (shadow->num >= RTW89_REG_SHADOW_MAX) {
+			rtw89_warn(rtwdev, "too many shadow registers\n");
+			break;
+		}
+
+		shadow->addr[shadow->num++] = addr;
+	}
+}
+
 int rtw89_core_init(struct rtw89_dev *rtwdev)
 {
 	struct rtw89_btc *btc = &rtwdev->btc;
 	u8 band;
+	u8 ac;
+	int ret;
 
 	INIT_LIST_HEAD(&rtwdev->ba_list);
+	atomic_set(&rtwdev->tx_tmpl_gen, 1);
+	rtw89_core_reg_shadow_init(rtwdev);
 	INIT_LIST_HEAD(&rtwdev->forbid_ba_list);
 	INIT_LIST_HEAD(&rtwdev->rtwvifs_list);
 	INIT_LIST_HEAD(&rtwdev->early_h2c_list);
@@ -4353,7 +5238,14 @@ int rtw89_core_init(struct rtw89_dev *rtwdev)
 	}
 	INIT_WORK(&rtwdev->ba_work, rtw89_core_ba_work);
 	INIT_WORK(&rtwdev->txq_work, rtw89_core_txq_work);
-	INIT_DELAYED_WORK(&rtwdev->txq_reinvoke_work, rtw89_core_txq_reinvoke_work);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 13, 0)
+	hrtimer_setup(&rtwdev->txq_reinvoke_timer, rtw89_core_txq_reinvoke_timer,
+		      CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+#else
+	hrtimer_init(&rtwdev->txq_reinvoke_timer, CLOCK_MONOTONIC,
+		     HRTIMER_MODE_ABS);
+	rtwdev->txq_reinvoke_timer.function = rtw89_core_txq_reinvoke_timer;
+#endif
 	INIT_DELAYED_WORK(&rtwdev->track_work, rtw89_track_work);
 	INIT_DELAYED_WORK(&rtwdev->chanctx_work, rtw89_chanctx_work);
 	INIT_DELAYED_WORK(&rtwdev->coex_act1_work, rtw89_coex_act1_work);
@@ -4365,7 +5257,14 @@ int rtw89_core_init(struct rtw89_dev *rtwdev)
 	rtwdev->txq_wq = alloc_workqueue("rtw89_tx_wq", WQ_UNBOUND | WQ_HIGHPRI, 0);
 	if (!rtwdev->txq_wq)
 		return -ENOMEM;
+	ret = rtw89_traffic_stats_init(rtwdev, &rtwdev->stats);
+	if (ret) {
+		destroy_workqueue(rtwdev->txq_wq);
+		return ret;
+	}
 	spin_lock_init(&rtwdev->ba_lock);
+	for (ac = 0; ac < IEEE80211_NUM_ACS; ac++)
+		spin_lock_init(&rtwdev->txq_sched_lock[ac]);
 	spin_lock_init(&rtwdev->rpwm_lock);
 	mutex_init(&rtwdev->mutex);
 	mutex_init(&rtwdev->rf_mutex);
@@ -4381,7 +5280,6 @@ int rtw89_core_init(struct rtw89_dev *rtwdev)
 
 	skb_queue_head_init(&rtwdev->c2h_queue);
 	rtw89_core_ppdu_sts_init(rtwdev);
-	rtw89_traffic_stats_init(rtwdev, &rtwdev->stats);
 
 	rtwdev->hal.rx_fltr = DEFAULT_AX_RX_FLTR;
 	rtwdev->dbcc_en = false;
@@ -4420,6 +5318,9 @@ void rtw89_core_deinit(struct rtw89_dev *rtwdev)
 	rtw89_unload_firmware(rtwdev);
 	rtw89_fw_free_all_early_h2c(rtwdev);
 
+	rtw89_traffic_stats_deinit(&rtwdev->stats);
+	if (rtwdev->tx_lat_stats.enabled)
+		static_branch_dec(&rtw89_tx_lat_key);
 	destroy_workqueue(rtwdev->txq_wq);
 	mutex_destroy(&rtwdev->rf_mutex);
 	mutex_destroy(&rtwdev->mutex);
@@ -4646,6 +5547,12 @@ static int rtw89_core_register_hw(struct rtw89_dev *rtwdev)
 	if (chip->support_bandwidths & BIT(NL80211_CHAN_WIDTH_160))
 		ieee80211_hw_set(hw, SUPPORTS_VHT_EXT_NSS_BW);
 
+	if (rtwdev->hci.tx_max_frags) {
+		ieee80211_hw_set(hw, TX_FRAG_LIST);
+		hw->max_tx_fragments = rtwdev->hci.tx_max_frags;
+		hw->netdev_features |= NETIF_F_SG;
+	}
+
 	if (RTW89_CHK_FW_FEATURE(BEACON_FILTER, &rtwdev->fw))
 		ieee80211_hw_set(hw, CONNECTION_MONITOR);
 
@@ -4698,6 +5605,8 @@ static int rtw89_core_register_hw(struct rtw89_dev *rtwdev)
 	wiphy_ext_feature_set(hw->wiphy, NL80211_EXT_FEATURE_CAN_REPLACE_PTK0);
 	wiphy_ext_feature_set(hw->wiphy, NL80211_EXT_FEATURE_SCAN_RANDOM_SN);
 	wiphy_ext_feature_set(hw->wiphy, NL80211_EXT_FEATURE_SET_SCAN_DWELL);
+	wiphy_ext_feature_set(hw->wiphy, NL80211_EXT_FEATURE_AIRTIME_FAIRNESS);
+	wiphy_ext_feature_set(hw->wiphy, NL80211_EXT_FEATURE_AQL);
 
 	ret = rtw89_core_set_supported_band(rtwdev);
 	if (ret) {
@@ -10,6 +10,8 @@
 #include <linux/dmi.h>
 #include <linux/firmware.h>
 #include <linux/iopoll.h>
+#include <linux/jump_label.h>
+#include <linux/u64_stats_sync.h>
 #include <linux/workqueue.h>
 #include <net/mac80211.h>
 #include <linux/version.h>
@@ -22,6 +24,7 @@ struct rtw89_efuse_block_cfg;
 struct rtw89_h2c_rf_tssi;
 struct rtw89_fw_txpwr_track_cfg;
 struct rtw89_phy_rfk_log_fmt;
+struct seq_file;
 
 extern const struct ieee80211_ops rtw89_ops;
 
@@ -200,6 +203,7 @@ enum rtw89_txq_flags {
 	RTW89_TXQ_F_AMPDU		= 0,
 	RTW89_TXQ_F_BLOCK_BA		= 1,
 	RTW89_TXQ_F_FORBID_BA		= 2,
+	RTW89_TXQ_F_STALLED		= 3,
 };
 
 enum rtw89_net_type {
@@ -1148,12 +1152,105 @@ struct rtw89_core_tx_request {
 	struct ieee80211_vif *vif;
 	struct ieee80211_sta *sta;
 	struct rtw89_tx_desc_info desc_info;
+	/* set only if TX latency is being sampled */
+	ktime_t enqueue_ts;
 };
 
+/* Fields of desc_info that are the same for all data frames of a station
+ * and TID. Valid while gen equals rtwdev->tx_tmpl_gen, which is bumped by
+ * rtw89_core_tx_tmpl_invalidate() on key, rate, BA, association and
+ * channel changes.
+ */
+struct rtw89_tx_desc_tmpl {
+	u32 gen;
+	u8 qsel;
+	u8 ch_dma;
+	u8 mac_id;
+	bool tid_indicate;
+	bool er_cap;
+	u16 data_retry_lowest_rate;
+	u8 ampdu_density;
+	u8 ampdu_num;
+
+	/* security fields are valid for this key only */
+	struct ieee80211_key_conf *key;
+	bool sec_en;
+	u8 sec_keyid;
+	u8 sec_type;
+	u8 sec_cam_idx;
+};
+
+struct rtw89_tx_desc_stats {
+	bool enabled;
+	atomic64_t cnt;
+	atomic64_t cycles;
+	atomic64_t tmpl_hit;
+	atomic64_t tmpl_miss;
+};
+
+#define RTW89_TX_LAT_BUCKETS 16
+
+enum rtw89_tx_lat_stage {
+	RTW89_TX_LAT_DRV,	/* from rtw89_core_tx_write() to doorbell */
+	RTW89_TX_LAT_HW,	/* from doorbell to release report */
+	RTW89_TX_LAT_TOTAL,
+
+	RTW89_TX_LAT_STAGE_NUM,
+};
+
+/* bucket 0 counts less than 2us, bucket n counts [2^n, 2^(n+1)) us, and
+ * the last bucket is open-ended.
+ */
+struct rtw89_tx_lat_hist {
+	u32 cnt[RTW89_TX_LAT_STAGE_NUM][RTW89_TX_LAT_BUCKETS];
+};
+
+struct rtw89_tx_lat_stats {
+	bool enabled;
+	struct rtw89_tx_lat_hist ac[IEEE80211_NUM_ACS];
+};
+
+/* stages of track_work in the order they run */
+enum rtw89_track_stage {
+	RTW89_TRACK_TRAFFIC,
+	RTW89_TRACK_TRAFFIC_VIF,
+	RTW89_TRACK_BF_MONITOR,
+	RTW89_TRACK_PHY_STAT,
+	RTW89_TRACK_ENV_MONITOR,
+	RTW89_TRACK_DIG,
+	RTW89_TRACK_RFK,
+	RTW89_TRACK_RA,
+	RTW89_TRACK_CFO,
+	RTW89_TRACK_TX_PATH_DIV,
+	RTW89_TRACK_ANTDIV,
+	RTW89_TRACK_UL_TB,
+	RTW89_TRACK_EDCCA,
+	RTW89_TRACK_TAS,
+	RTW89_TRACK_CHANCTX,
+	RTW89_TRACK_LPS,
+
+	RTW89_TRACK_STAGE_NUM,
+};
+
+struct rtw89_track_stage_stats {
+	u64 cnt;
+	u64 total_us;
+	u32 last_us;
+	u32 max_us;
+};
+
+DECLARE_EWMA(txq_ia, 4, 8);
+
 struct rtw89_txq {
 	struct list_head list;
 	unsigned long flags;
-	int wait_cnt;
+	/* deadline of the frame held back to aggregate, 0 if none */
+	ktime_t hold_until;
+	ktime_t last_wake;
+	/* inter-arrival time of wake_tx_queue in us */
+	struct ewma_txq_ia ia_us;
+	u64 push_cnt;
+	u64 push_frames;
 };
 
 struct rtw89_mac_ax_gnt {
@@ -1352,14 +1449,28 @@ enum rtw89_tfc_lv {
 #define RTW89_TP_SHIFT 18 /* bytes/2s --> Mbps */
 DECLARE_EWMA(tp, 10, 2);
 
+/* running totals, only ever increased by the CPU owning them */
+struct rtw89_traffic_pcpu {
+	u64 tx_unicast;
+	u64 rx_unicast;
+	u64 tx_cnt;
+	u64 rx_cnt;
+	/* u64 can't be read in one go on 32-bit */
+	struct u64_stats_sync syncp;
+};
+
 struct rtw89_traffic_stats {
-	/* units in bytes */
+	struct rtw89_traffic_pcpu __percpu *pcpu;
+	/* sum of pcpu at the last rtw89_traffic_stats_calc() */
+	struct rtw89_traffic_pcpu folded;
+
+	/* units in bytes, during the last track period */
 	u64 tx_unicast;
 	u64 rx_unicast;
 	u32 tx_avg_len;
 	u32 rx_avg_len;
 
-	/* count for packets */
+	/* count for packets, during the last track period */
 	u64 tx_cnt;
 	u64 rx_cnt;
 
@@ -3300,8 +3411,13 @@ struct rtw89_sta {
 	struct ewma_evm evm_max[RF_PATH_MAX];
 	struct rtw89_ampdu_params ampdu_params[IEEE80211_NUM_TIDS];
 	DECLARE_BITMAP(ampdu_map, IEEE80211_NUM_TIDS);
+	struct rtw89_tx_desc_tmpl tx_tmpl[IEEE80211_NUM_TIDS];
 	struct ieee80211_rx_status rx_status;
 	u16 rx_hw_rate;
+	/* accumulated airtime in us, as reported to mac80211 */
+	atomic64_t tx_airtime;
+	atomic64_t rx_airtime;
+	struct rtw89_tx_lat_hist tx_lat;
 	__le32 htc_template;
 	struct rtw89_addr_cam_entry addr_cam; /* AP mode or TDLS peer only */
 	struct rtw89_bssid_cam_entry bssid_cam; /* TDLS peer only */
@@ -3443,10 +3559,18 @@ enum rtw89_lv1_rcvy_step {
 	RTW89_LV1_RCVY_STEP_2,
 };
 
+/* how long flush_queues waits for TX frames to be released */
+enum rtw89_flush_mode {
+	RTW89_FLUSH_DROP, /* frames are going to be dropped, don't wait */
+	RTW89_FLUSH_SHORT, /* bounded short wait, for paths holding the mutex */
+	RTW89_FLUSH_WAIT,
+};
+
 struct rtw89_hci_ops {
 	int (*tx_write)(struct rtw89_dev *rtwdev, struct rtw89_core_tx_request *tx_req);
 	void (*tx_kick_off)(struct rtw89_dev *rtwdev, u8 txch);
-	void (*flush_queues)(struct rtw89_dev *rtwdev, u32 queues, bool drop);
+	void (*flush_queues)(struct rtw89_dev *rtwdev, u32 queues,
+			     enum rtw89_flush_mode mode);
 	void (*reset)(struct rtw89_dev *rtwdev);
 	int (*start)(struct rtw89_dev *rtwdev);
 	void (*stop)(struct rtw89_dev *rtwdev);
@@ -3470,6 +3594,8 @@ struct rtw89_hci_ops {
 	int (*mac_lv1_rcvy)(struct rtw89_dev *rtwdev, enum rtw89_lv1_rcvy_step step);
 	void (*dump_err_status)(struct rtw89_dev *rtwdev);
 	int (*napi_poll)(struct napi_struct *napi, int budget);
+	/* optional, poll TX completion apart from RX if provided */
+	int (*napi_poll_tx)(struct napi_struct *napi, int budget);
 
 	/* Deal with locks inside recovery_start and recovery_complete callbacks
 	 * by hci instance, and handle things which need to consider under SER.
@@ -3487,6 +3613,14 @@ struct rtw89_hci_ops {
 	void (*disable_intr)(struct rtw89_dev *rtwdev);
 	void (*enable_intr)(struct rtw89_dev *rtwdev);
 	int (*rst_bdram)(struct rtw89_dev *rtwdev);
+
+	/* optional, dump and tune HCI internals through debugfs */
+	void (*dump_stats)(struct rtw89_dev *rtwdev, struct seq_file *m);
+	void (*dump_rx_mit)(struct rtw89_dev *rtwdev, struct seq_file *m);
+	int (*set_rx_mit)(struct rtw89_dev *rtwdev, u32 ix);
+	void (*dump_rings)(struct rtw89_dev *rtwdev, struct seq_file *m);
+	int (*set_rings)(struct rtw89_dev *rtwdev, bool tx, u32 ch, u32 bd,
+			 u32 wd);
 };
 
 struct rtw89_hci_info {
@@ -3495,6 +3629,8 @@ struct rtw89_hci_info {
 	u32 rpwm_addr;
 	u32 cpwm_addr;
 	bool paused;
+	/* buffers of a nonlinear skb HCI can take, 0 for linear skb only */
+	u8 tx_max_frags;
 };
 
 struct rtw89_chip_ops {
@@ -4075,6 +4211,26 @@ struct rtw89_dig_regs {
 	struct rtw89_reg_def p1_s20_pagcugc_en;
 };
 
+/* BB registers only written by host, so read-modify-write of them can use
+ * the last written value instead of reading back over MMIO.
+ */
+struct rtw89_reg_shadow_cfg {
+	const u32 *phy_regs;
+	u8 n_phy_regs;
+};
+
+#define RTW89_REG_SHADOW_MAX 32
+
+struct rtw89_reg_shadow {
+	u8 num;
+	u32 addr[RTW89_REG_SHADOW_MAX];
+	u32 val[RTW89_REG_SHADOW_MAX];
+	DECLARE_BITMAP(valid, RTW89_REG_SHADOW_MAX);
+
+	atomic64_t read_saved;
+	atomic64_t read_miss;
+};
+
 struct rtw89_edcca_regs {
 	u32 edcca_level;
 	u32 edcca_mask;
@@ -4192,6 +4348,8 @@ struct rtw89_chip_info {
 	const struct rtw89_rfk_tbl *nctl_post_table;
 	const struct rtw89_phy_dig_gain_table *dig_table;
 	const struct rtw89_dig_regs *dig_regs;
+	/* NULL if no register is cached */
+	const struct rtw89_reg_shadow_cfg *reg_shadow;
 	const struct rtw89_phy_tssi_dbw_table *tssi_dbw_table;
 
 	/* NULL if no rfe-specific, or a null-terminated array by rfe_parms */
@@ -5073,9 +5231,39 @@ struct rtw89_lps_parm {
 	u8 lastrpwm; /* enum rtw89_last_rpwm_mode */
 };
 
+/* upper bound of holding frames to wait for their PPDU status */
+#define RTW89_PPDU_STS_HOLD_US 2000
+
+struct rtw89_ppdu_slot {
+	struct sk_buff_head frames;
+	struct rtw89_rx_desc_info desc;
+	ktime_t since;
+};
+
+struct rtw89_ppdu_sts_stats {
+	u64 held;
+	/* frames released with PPDU status */
+	u64 matched;
+	u64 unmatched;
+	/* frames released without PPDU status */
+	u64 evicted;
+	u64 expired;
+
+	u64 hold_cnt;
+	u64 hold_total_us;
+	u32 hold_max_us;
+};
+
+/* accessed in NAPI context only, except @enabled */
 struct rtw89_ppdu_sts_info {
-	struct sk_buff_head rx_queue[RTW89_PHY_MAX];
+	/* frames waiting for PPDU status, indexed by ppdu_cnt */
+	struct rtw89_ppdu_slot slots[RTW89_PHY_MAX][RTW89_MAX_PPDU_CNT];
+	unsigned long pending[RTW89_PHY_MAX];
 	u8 curr_rx_ppdu_cnt[RTW89_PHY_MAX];
+	/* no frame is held while PPDU status is off */
+	bool enabled[RTW89_PHY_MAX];
+	struct hrtimer hold_timer;
+	struct rtw89_ppdu_sts_stats stats;
 };
 
 struct rtw89_early_h2c {
@@ -5374,6 +5562,14 @@ struct rtw89_mcc_info {
 	struct rtw89_mcc_config config;
 };
 
+/* How frames woken by wake_tx_queue reached the TX rings */
+struct rtw89_txq_path_stats {
+	atomic64_t direct; /* pushed in context of wake_tx_queue */
+	atomic64_t direct_fallback; /* direct, but left frames to txq_work */
+	atomic64_t deferred; /* left to txq_work entirely */
+	atomic64_t work; /* runs of txq_work */
+};
+
 struct rtw89_dev {
 	struct ieee80211_hw *hw;
 	struct device *dev;
@@ -5399,9 +5595,18 @@ struct rtw89_dev {
 	struct list_head rtwvifs_list;
 	/* used to protect rf read write */
 	struct mutex rf_mutex;
+	struct rtw89_reg_shadow reg_shadow;
 	struct workqueue_struct *txq_wq;
 	struct work_struct txq_work;
-	struct delayed_work txq_reinvoke_work;
+	/* mac80211 requires scheduling rounds of an AC not to run concurrently */
+	spinlock_t txq_sched_lock[IEEE80211_NUM_ACS];
+	struct hrtimer txq_reinvoke_timer;
+	/* number of txqs with RTW89_TXQ_F_STALLED */
+	atomic_t txq_stalled;
+	struct rtw89_txq_path_stats txq_path_stats;
+	atomic_t tx_tmpl_gen;
+	struct rtw89_tx_desc_stats tx_desc_stats;
+	struct rtw89_tx_lat_stats tx_lat_stats;
 	/* used to protect ba_list and forbid_ba_list */
 	spinlock_t ba_lock;
 	/* txqs to setup ba session */
@@ -5426,6 +5631,8 @@ struct rtw89_dev {
 
 	DECLARE_BITMAP(hw_port, RTW89_PORT_NUM);
 	DECLARE_BITMAP(mac_id_map, RTW89_MAX_MAC_ID_NUM);
+	/* look up station by mac_id in RX and C2H paths, protected by RCU */
+	struct rtw89_sta __rcu *sta_on_macid[RTW89_MAX_MAC_ID_NUM];
 	DECLARE_BITMAP(flags, NUM_OF_RTW89_FLAGS);
 	DECLARE_BITMAP(pkt_offload, RTW89_MAX_PKT_OFLD_NUM);
 	DECLARE_BITMAP(quirks, NUM_OF_RTW89_QUIRKS);
@@ -5459,6 +5666,8 @@ struct rtw89_dev {
 	struct rtw89_antdiv_info antdiv;
 
 	struct delayed_work track_work;
+	/* only written by track_work */
+	struct rtw89_track_stage_stats track_stats[RTW89_TRACK_STAGE_NUM];
 	struct delayed_work chanctx_work;
 	struct delayed_work coex_act1_work;
 	struct delayed_work coex_bt_devinfo_work;
@@ -5484,7 +5693,10 @@ struct rtw89_dev {
 	/* napi structure */
 	struct net_device netdev;
 	struct napi_struct napi;
+	struct napi_struct napi_tx;
 	int napi_budget_countdown;
+	/* frames received in current RX poll, see rtw89_core_napi_rx_flush() */
+	struct list_head napi_rx_list;
 
 	/* HCI related data, keep last */
 	u8 priv[] __aligned(sizeof(void *));
@@ -5496,6 +5708,11 @@ static inline int rtw89_hci_tx_write(struct rtw89_dev *rtwdev,
 	return rtwdev->hci.ops->tx_write(rtwdev, tx_req);
 }
 
+static inline void rtw89_core_tx_tmpl_invalidate(struct rtw89_dev *rtwdev)
+{
+	atomic_inc(&rtwdev->tx_tmpl_gen);
+}
+
 static inline void rtw89_hci_reset(struct rtw89_dev *rtwdev)
 {
 	rtwdev->hci.ops->reset(rtwdev);
@@ -5547,13 +5764,13 @@ static inline int rtw89_hci_mac_pre_deinit(struct rtw89_dev *rtwdev)
 }
 
 static inline void rtw89_hci_flush_queues(struct rtw89_dev *rtwdev, u32 queues,
-					  bool drop)
+					  enum rtw89_flush_mode mode)
 {
 	if (!test_bit(RTW89_FLAG_POWERON, rtwdev->flags))
 		return;
 
 	if (rtwdev->hci.ops->flush_queues)
-		return rtwdev->hci.ops->flush_queues(rtwdev, queues, drop);
+		return rtwdev->hci.ops->flush_queues(rtwdev, queues, mode);
 }
 
 static inline void rtw89_hci_recovery_start(struct rtw89_dev *rtwdev)
@@ -5651,6 +5868,54 @@ static inline u32 rtw89_read32(struct rtw89_dev *rtwdev, u32 addr)
 	return rtwdev->hci.ops->read32(rtwdev, addr);
 }
 
+static inline int rtw89_reg_shadow_find(struct rtw89_dev *rtwdev, u32 addr)
+{
+	struct rtw89_reg_shadow *shadow = &rtwdev->reg_shadow;
+	int i;
+
+	for (i = 0; i < shadow->num; i++)
+		if (shadow->addr[i] == addr)
+			return i;
+
+	return -ENOENT;
+}
+
+static inline void rtw89_reg_shadow_invalidate(struct rtw89_dev *rtwdev)
+{
+	bitmap_zero(rtwdev->reg_shadow.valid, RTW89_REG_SHADOW_MAX);
+}
+
+static inline void rtw89_reg_shadow_update(struct rtw89_dev *rtwdev, u32 addr,
+					   u32 data)
+{
+	struct rtw89_reg_shadow *shadow = &rtwdev->reg_shadow;
+	int i;
+
+	if (likely(!shadow->num))
+		return;
+
+	i = rtw89_reg_shadow_find(rtwdev, addr);
+	if (i < 0)
+		return;
+
+	shadow->val[i] = data;
+	set_bit(i, shadow->valid);
+}
+
+/* byte and word writes aren't tracked, so just drop the dword */
+static inline void rtw89_reg_shadow_drop(struct rtw89_dev *rtwdev, u32 addr)
+{
+	struct rtw89_reg_shadow *shadow = &rtwdev->reg_shadow;
+	int i;
+
+	if (likely(!shadow->num))
+		return;
+
+	i = rtw89_reg_shadow_find(rtwdev, addr & ~0x3);
+	if (i >= 0)
+		clear_bit(i, shadow->valid);
+}
+
 static inline void rtw89_write8(struct rtw89_dev *rtwdev, u32 addr, u8 data)
 {
 	rtwdev->hci.ops->write8(rtwdev, addr, data);
@@ -5666,6 +5931,28 @@ static inline void rtw89_write32(struct rtw89_dev *rtwdev, u32 addr, u32 data)
 	rtwdev->hci.ops->write32(rtwdev, addr, data);
 }
 
+/* read a dword for read-modify-write, from shadow if it's cached */
+static inline u32 rtw89_read32_rmw(struct rtw89_dev *rtwdev, u32 addr)
+{
+	struct rtw89_reg_shadow *shadow = &rtwdev->reg_shadow;
+	int i;
+
+	if (likely(!shadow->num))
+		return rtw89_read32(rtwdev, addr);
+
+	i = rtw89_reg_shadow_find(rtwdev, addr);
+	if (i < 0)
+		return rtw89_read32(rtwdev, addr);
+
+	if (test_bit(i, shadow->valid)) {
+		atomic64_inc(&shadow->read_saved);
+		return shadow->val[i];
+	}
+
+	atomic64_inc(&shadow->read_miss);
+	return rtw89_read32(rtwdev, addr);
+}
+
 static inline void
 rtw89_write8_set(struct rtw89_dev *rtwdev, u32 addr, u8 bit)
 {
@@ -5840,6 +6127,42 @@ static inline void rtw89_core_txq_init(struct rtw89_dev *rtwdev,
 
 	rtwtxq = (struct rtw89_txq *)txq->drv_priv;
 	INIT_LIST_HEAD(&rtwtxq->list);
+	ewma_txq_ia_init(&rtwtxq->ia_us);
+}
+
+/* A txq is stalled if frames are left in it for lack of TX resource or
+ * AQL budget, both of which are given back by TX release only.
+ */
+static inline void rtw89_core_txq_set_stalled(struct rtw89_dev *rtwdev,
+					      struct rtw89_txq *rtwtxq,
+					      bool stalled)
+{
+	if (stalled) {
+		if (!test_and_set_bit(RTW89_TXQ_F_STALLED, &rtwtxq->flags))
+			atomic_inc(&rtwdev->txq_stalled);
+	} else if (test_and_clear_bit(RTW89_TXQ_F_STALLED, &rtwtxq->flags)) {
+		atomic_dec(&rtwdev->txq_stalled);
+	}
+}
+
+static inline void rtw89_core_txq_deinit(struct rtw89_dev *rtwdev,
+					 struct ieee80211_txq *txq)
+{
+	if (!txq)
+		return;
+
+	rtw89_core_txq_set_stalled(rtwdev, (struct rtw89_txq *)txq->drv_priv,
+				   false);
+}
+
+/* AQL keeps frames in mac80211 until airtime is released on TX status,
+ * so give the scheduler another chance once a poll of TX release reports
+ * completed some frames, if any txq is waiting for that.
+ */
+static inline void rtw89_core_txq_tx_done(struct rtw89_dev *rtwdev)
+{
+	if (atomic_read(&rtwdev->txq_stalled))
+		queue_work(rtwdev->txq_wq, &rtwdev->txq_work);
 }
 
 static inline struct ieee80211_vif *rtwvif_to_vif(struct rtw89_vif *rtwvif)
@@ -5876,6 +6199,15 @@ static inline struct rtw89_sta *sta_to_rtwsta_safe(struct ieee80211_sta *sta)
 	return sta ? (struct rtw89_sta *)sta->drv_priv : NULL;
 }
 
+static inline struct rtw89_sta *rtw89_sta_rcu_dereference(struct rtw89_dev *rtwdev,
+							  u8 mac_id)
+{
+	if (unlikely(mac_id >= RTW89_MAX_MAC_ID_NUM))
+		return NULL;
+
+	return rcu_dereference(rtwdev->sta_on_macid[mac_id]);
+}
+
 static inline u8 rtw89_hw_to_rate_info_bw(enum rtw89_bandwidth hw_bw)
 {
 	if (hw_bw == RTW89_CHANNEL_WIDTH_160)
@@ -6442,6 +6774,7 @@ int rtw89_core_tx_write(struct rtw89_dev *rtwdev, struct ieee80211_vif *vif,
 int rtw89_h2c_tx(struct rtw89_dev *rtwdev,
 		 struct sk_buff *skb, bool fwdl);
 void rtw89_core_tx_kick_off(struct rtw89_dev *rtwdev, u8 qsel);
+void rtw89_core_txq_wake(struct rtw89_dev *rtwdev, struct ieee80211_txq *txq);
 int rtw89_core_tx_kick_off_and_wait(struct rtw89_dev *rtwdev, struct sk_buff *skb,
 				    int qsel, unsigned int timeout);
 void rtw89_core_fill_txdesc(struct rtw89_dev *rtwdev,
@@ -6468,8 +6801,16 @@ void rtw89_core_query_rxdesc(struct rtw89_dev *rtwdev,
 void rtw89_core_query_rxdesc_v2(struct rtw89_dev *rtwdev,
 				struct rtw89_rx_desc_info *desc_info,
 				u8 *data, u32 data_offset);
+void rtw89_core_napi_rx_flush(struct rtw89_dev *rtwdev);
+void rtw89_core_tx_lat_enable(struct rtw89_dev *rtwdev, bool enable);
+void rtw89_core_tx_lat_report(struct rtw89_dev *rtwdev, u8 mac_id, u8 ac,
+			      ktime_t enqueue, ktime_t kick);
+void rtw89_core_tx_airtime_report(struct rtw89_dev *rtwdev, u8 mac_id, u8 tid,
+				  u32 len, bool sent);
 void rtw89_core_napi_start(struct rtw89_dev *rtwdev);
 void rtw89_core_napi_stop(struct rtw89_dev *rtwdev);
+void rtw89_core_napi_synchronize(struct rtw89_dev *rtwdev);
+void rtw89_core_napi_schedule_all(struct rtw89_dev *rtwdev);
 void rtw89_core_napi_init(struct rtw89_dev *rtwdev);
 void rtw89_core_napi_deinit(struct rtw89_dev *rtwdev);
 int rtw89_core_sta_add(struct rtw89_dev *rtwdev,
@@ -6522,8 +6863,9 @@ int rtw89_regd_setup(struct rtw89_dev *rtwdev);
 int rtw89_regd_init(struct rtw89_dev *rtwdev,
 		    void (*reg_notifier)(struct wiphy *wiphy, struct regulatory_request *request));
 void rtw89_regd_notifier(struct wiphy *wiphy, struct regulatory_request *request);
-void rtw89_traffic_stats_init(struct rtw89_dev *rtwdev,
-			      struct rtw89_traffic_stats *stats);
+int rtw89_traffic_stats_init(struct rtw89_dev *rtwdev,
+			     struct rtw89_traffic_stats *stats);
+void rtw89_traffic_stats_deinit(struct rtw89_traffic_stats *stats);
 int rtw89_wait_for_cond(struct rtw89_wait_info *wait, unsigned int cond);
 void rtw89_complete_cond(struct rtw89_wait_info *wait, unsigned int cond,
 			 const struct rtw89_completion_data *data);
@@ -3468,6 +3468,41 @@ out:
 	return count;
 }
 
+static void rtw89_sta_info_get_agg(struct seq_file *m, struct ieee80211_sta *sta,
+				   struct rtw89_sta *rtwsta)
+{
+	u64 push_cnt = 0, push_frames = 0;
+	struct rtw89_txq *rtwtxq;
+	u64 avg;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(sta->txq); i++) {
+		if (!sta->txq[i])
+			continue;
+
+		rtwtxq = (struct rtw89_txq *)sta->txq[i]->drv_priv;
+		push_cnt += rtwtxq->push_cnt;
+		push_frames += rtwtxq->push_frames;
+	}
+
+	avg = push_cnt ? div64_u64(push_frames * 100, push_cnt) : 0;
+	seq_printf(m, "TX agg [%d]: %llu.%02llu frames/push (%llu pushes)",
+		   rtwsta->mac_id, avg / 100, avg % 100, push_cnt);
+
+	for (i = 0; i < ARRAY_SIZE(sta->txq); i++) {
+		if (!sta->txq[i])
+			continue;
+
+		rtwtxq = (struct rtw89_txq *)sta->txq[i]->drv_priv;
+		if (!rtwtxq->push_cnt)
+			continue;
+
+		seq_printf(m, " tid%d:ia=%luus", i,
+			   ewma_txq_ia_read(&rtwtxq->ia_us));
+	}
+	seq_puts(m, "\n");
+}
+
 static void rtw89_sta_info_get_iter(void *data, struct ieee80211_sta *sta)
 {
 	static const char * const he_gi_str[] = {
@@ -3525,6 +3560,11 @@ static void rtw89_sta_info_get_iter(void *data, struct ieee80211_sta *sta)
 		   sta->max_rc_amsdu_len);
 #endif
 
+	rtw89_sta_info_get_agg(m, sta, rtwsta);
+	seq_printf(m, "Airtime [%d]: TX %lld us RX %lld us\n", rtwsta->mac_id,
+		   atomic64_read(&rtwsta->tx_airtime),
+		   atomic64_read(&rtwsta->rx_airtime));
+
 	seq_printf(m, "RX rate [%d]: ", rtwsta->mac_id);
 
 	switch (status->encoding) {
@@ -3788,6 +3828,349 @@ static int rtw89_debug_priv_stations_get(struct seq_file *m, void *v)
 	return 0;
 }
 
+static int rtw89_debug_priv_txq_stats_get(struct seq_file *m, void *v)
+{
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+	struct rtw89_txq_path_stats *path_stats = &rtwdev->txq_path_stats;
+
+	seq_printf(m, "direct: %lld\n", atomic64_read(&path_stats->direct));
+	seq_printf(m, "direct, then worker: %lld\n",
+		   atomic64_read(&path_stats->direct_fallback));
+	seq_printf(m, "deferred to worker: %lld\n",
+		   atomic64_read(&path_stats->deferred));
+	seq_printf(m, "worker runs: %lld\n", atomic64_read(&path_stats->work));
+	seq_printf(m, "stalled txqs: %d\n", atomic_read(&rtwdev->txq_stalled));
+
+	return 0;
+}
+
+static int rtw89_debug_priv_tx_desc_stats_get(struct seq_file *m, void *v)
+{
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+	struct rtw89_tx_desc_stats *desc_stats = &rtwdev->tx_desc_stats;
+	s64 cnt = atomic64_read(&desc_stats->cnt);
+	s64 cycles = atomic64_read(&desc_stats->cycles);
+
+	seq_printf(m, "enabled: %d\n", desc_stats->enabled);
+	seq_printf(m, "descriptors: %lld\n", cnt);
+	seq_printf(m, "cycles: %lld (%lld per descriptor)\n", cycles,
+		   cnt ? div64_s64(cycles, cnt) : 0);
+	seq_printf(m, "template hit/miss: %lld/%lld\n",
+		   atomic64_read(&desc_stats->tmpl_hit),
+		   atomic64_read(&desc_stats->tmpl_miss));
+	seq_puts(m, "write 1 to clear and start counting, 0 to stop\n");
+
+	return 0;
+}
+
+static ssize_t
+rtw89_debug_priv_tx_desc_stats_set(struct file *filp, const char __user *user_buf,
+				   size_t count, loff_t *loff)
+{
+	struct seq_file *m = (struct seq_file *)filp->private_data;
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+	struct rtw89_tx_desc_stats *desc_stats = &rtwdev->tx_desc_stats;
+	bool enable;
+	int ret;
+
+	ret = kstrtobool_from_user(user_buf, count, &enable);
+	if (ret)
+		return -EINVAL;
+
+	WRITE_ONCE(desc_stats->enabled, false);
+	if (enable) {
+		atomic64_set(&desc_stats->cnt, 0);
+		atomic64_set(&desc_stats->cycles, 0);
+		atomic64_set(&desc_stats->tmpl_hit, 0);
+		atomic64_set(&desc_stats->tmpl_miss, 0);
+		WRITE_ONCE(desc_stats->enabled, true);
+	}
+
+	return count;
+}
+
+static const char * const rtw89_track_stage_names[RTW89_TRACK_STAGE_NUM] = {
+	[RTW89_TRACK_TRAFFIC] = "traffic",
+	[RTW89_TRACK_TRAFFIC_VIF] = "traffic_vif",
+	[RTW89_TRACK_BF_MONITOR] = "bf_monitor",
+	[RTW89_TRACK_PHY_STAT] = "phy_stat",
+	[RTW89_TRACK_ENV_MONITOR] = "env_monitor",
+	[RTW89_TRACK_DIG] = "dig",
+	[RTW89_TRACK_RFK] = "rfk",
+	[RTW89_TRACK_RA] = "ra",
+	[RTW89_TRACK_CFO] = "cfo",
+	[RTW89_TRACK_TX_PATH_DIV] = "tx_path_div",
+	[RTW89_TRACK_ANTDIV] = "antdiv",
+	[RTW89_TRACK_UL_TB] = "ul_tb",
+	[RTW89_TRACK_EDCCA] = "edcca",
+	[RTW89_TRACK_TAS] = "tas",
+	[RTW89_TRACK_CHANCTX] = "chanctx",
+	[RTW89_TRACK_LPS] = "lps",
+};
+
+static int rtw89_debug_priv_track_stats_get(struct seq_file *m, void *v)
+{
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+	const struct rtw89_track_stage_stats *stats;
+	int i;
+
+	seq_printf(m, "%-12s %10s %8s %8s %8s\n",
+		   "stage", "cnt", "last_us", "avg_us", "max_us");
+
+	for (i = 0; i < RTW89_TRACK_STAGE_NUM; i++) {
+		stats = &rtwdev->track_stats[i];
+		seq_printf(m, "%-12s %10llu %8u %8llu %8u\n",
+			   rtw89_track_stage_names[i], stats->cnt, stats->last_us,
+			   stats->cnt ? div64_u64(stats->total_us, stats->cnt) : 0,
+			   stats->max_us);
+	}
+
+	return 0;
+}
+
+static const char * const rtw89_tx_lat_stage_names[RTW89_TX_LAT_STAGE_NUM] = {
+	[RTW89_TX_LAT_DRV] = "drv",
+	[RTW89_TX_LAT_HW] = "hw",
+	[RTW89_TX_LAT_TOTAL] = "total",
+};
+
+static const char * const rtw89_ac_names[IEEE80211_NUM_ACS] = {
+	[IEEE80211_AC_VO] = "VO",
+	[IEEE80211_AC_VI] = "VI",
+	[IEEE80211_AC_BE] = "BE",
+	[IEEE80211_AC_BK] = "BK",
+};
+
+static void rtw89_debug_tx_lat_hist(struct seq_file *m, const char *name,
+				    const struct rtw89_tx_lat_hist *hist)
+{
+	int i, j;
+
+	for (i = 0; i < RTW89_TX_LAT_STAGE_NUM; i++) {
+		seq_printf(m, "%-9s %-5s", name, rtw89_tx_lat_stage_names[i]);
+		for (j = 0; j < RTW89_TX_LAT_BUCKETS; j++)
+			seq_printf(m, " %6u", hist->cnt[i][j]);
+		seq_puts(m, "\n");
+	}
+}
+
+static void rtw89_sta_tx_lat_get_iter(void *data, struct ieee80211_sta *sta)
+{
+	struct rtw89_sta *rtwsta = (struct rtw89_sta *)sta->drv_priv;
+	struct seq_file *m = (struct seq_file *)data;
+	char name[16];
+
+	snprintf(name, sizeof(name), "mac_id%u", rtwsta->mac_id);
+	rtw89_debug_tx_lat_hist(m, name, &rtwsta->tx_lat);
+}
+
+static int rtw89_debug_priv_tx_latency_get(struct seq_file *m, void *v)
+{
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+	struct rtw89_tx_lat_stats *lat_stats = &rtwdev->tx_lat_stats;
+	int i;
+
+	seq_printf(m, "enabled: %d\n", lat_stats->enabled);
+	seq_puts(m, "drv: enqueue to doorbell, hw: doorbell to release report\n");
+
+	seq_printf(m, "%-15s", "from (us)");
+	for (i = 0; i < RTW89_TX_LAT_BUCKETS; i++)
+		seq_printf(m, " %6u", i ? 1U << i : 0);
+	seq_puts(m, "\n");
+
+	for (i = 0; i < IEEE80211_NUM_ACS; i++)
+		rtw89_debug_tx_lat_hist(m, rtw89_ac_names[i], &lat_stats->ac[i]);
+
+	ieee80211_iterate_stations_atomic(rtwdev->hw, rtw89_sta_tx_lat_get_iter, m);
+
+	seq_puts(m, "write 1 to clear and start counting, 0 to stop\n");
+
+	return 0;
+}
+
+static ssize_t
+rtw89_debug_priv_tx_latency_set(struct file *filp, const char __user *user_buf,
+				size_t count, loff_t *loff)
+{
+	struct seq_file *m = (struct seq_file *)filp->private_data;
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+	bool enable;
+	int ret;
+
+	ret = kstrtobool_from_user(user_buf, count, &enable);
+	if (ret)
+		return -EINVAL;
+
+	mutex_lock(&rtwdev->mutex);
+	rtw89_core_tx_lat_enable(rtwdev, enable);
+	mutex_unlock(&rtwdev->mutex);
+
+	return count;
+}
+
+static int rtw89_debug_priv_ppdu_sts_get(struct seq_file *m, void *v)
+{
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+	const struct rtw89_ppdu_sts_stats *stats = &rtwdev->ppdu_sts.stats;
+	u64 released = stats->matched + stats->unmatched +
+		       stats->evicted + stats->expired;
+	u64 per_mille, quot;
+	u32 rem;
+
+	per_mille = released ? div64_u64(stats->matched * 1000, released) : 0;
+	quot = div_u64_rem(per_mille, 1000, &rem);
+
+	seq_printf(m, "held frames: %llu\n", stats->held);
+	seq_printf(m, "with status: matched=%llu unmatched=%llu\n",
+		   stats->matched, stats->unmatched);
+	seq_printf(m, "without status: evicted=%llu expired=%llu\n",
+		   stats->evicted, stats->expired);
+	seq_printf(m, "match rate: %llu.%03u\n", quot, rem);
+	seq_printf(m, "hold (per PPDU): cnt=%llu avg=%lluus max=%uus limit=%uus\n",
+		   stats->hold_cnt,
+		   stats->hold_cnt ? div64_u64(stats->hold_total_us, stats->hold_cnt) : 0,
+		   stats->hold_max_us, RTW89_PPDU_STS_HOLD_US);
+
+	return 0;
+}
+
+static int rtw89_debug_priv_reg_shadow_get(struct seq_file *m, void *v)
+{
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+	struct rtw89_reg_shadow *shadow = &rtwdev->reg_shadow;
+	int i;
+
+	seq_printf(m, "MMIO reads saved: %lld\n",
+		   atomic64_read(&shadow->read_saved));
+	seq_printf(m, "MMIO reads missed: %lld\n",
+		   atomic64_read(&shadow->read_miss));
+
+	for (i = 0; i < shadow->num; i++) {
+		if (test_bit(i, shadow->valid))
+			seq_printf(m, "\t0x%05x = 0x%08x\n", shadow->addr[i],
+				   shadow->val[i]);
+		else
+			seq_printf(m, "\t0x%05x = (invalid)\n", shadow->addr[i]);
+	}
+
+	return 0;
+}
+
+static int rtw89_debug_priv_pci_stats_get(struct seq_file *m, void *v)
+{
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+
+	if (!rtwdev->hci.ops->dump_stats) {
+		seq_puts(m, "not supported by HCI\n");
+		return 0;
+	}
+
+	rtwdev->hci.ops->dump_stats(rtwdev, m);
+
+	return 0;
+}
+
+static int rtw89_debug_priv_pci_rx_mit_get(struct seq_file *m, void *v)
+{
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+
+	if (!rtwdev->hci.ops->dump_rx_mit) {
+		seq_puts(m, "not supported by HCI\n");
+		return 0;
+	}
+
+	rtwdev->hci.ops->dump_rx_mit(rtwdev, m);
+
+	return 0;
+}
+
+static ssize_t
+rtw89_debug_priv_pci_rx_mit_set(struct file *filp, const char __user *user_buf,
+				size_t count, loff_t *loff)
+{
+	struct seq_file *m = (struct seq_file *)filp->private_data;
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+	u32 ix;
+	int ret;
+
+	if (!rtwdev->hci.ops->set_rx_mit)
+		return -EOPNOTSUPP;
+
+	ret = kstrtou32_from_user(user_buf, count, 0, &ix);
+	if (ret)
+		return -EINVAL;
+
+	ret = rtwdev->hci.ops->set_rx_mit(rtwdev, ix);
+
+	return ret ? ret : count;
+}
+
+static int rtw89_debug_priv_pci_rings_get(struct seq_file *m, void *v)
+{
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+
+	if (!rtwdev->hci.ops->dump_rings) {
+		seq_puts(m, "not supported by HCI\n");
+		return 0;
+	}
+
+	mutex_lock(&rtwdev->mutex);
+	rtwdev->hci.ops->dump_rings(rtwdev, m);
+	mutex_unlock(&rtwdev->mutex);
+
+	seq_puts(m, "write \"tx <ch> <bd> <wd>\" or \"rx <ch> <bd>\", 0 for default;\n");
+	seq_puts(m, "rings are reallocated at next power on, e.g. interface up\n");
+
+	return 0;
+}
+
+static ssize_t
+rtw89_debug_priv_pci_rings_set(struct file *filp, const char __user *user_buf,
+			       size_t count, loff_t *loff)
+{
+	struct seq_file *m = (struct seq_file *)filp->private_data;
+	struct rtw89_debugfs_priv *debugfs_priv = m->private;
+	struct rtw89_dev *rtwdev = debugfs_priv->rtwdev;
+	char buf[32] = {0};
+	size_t buf_size;
+	char dir[3];
+	u32 ch, bd, wd = 0;
+	int num;
+	int ret;
+
+	if (!rtwdev->hci.ops->set_rings)
+		return -EOPNOTSUPP;
+
+	buf_size = min(count, sizeof(buf) - 1);
+	if (copy_from_user(buf, user_buf, buf_size))
+		return -EFAULT;
+
+	buf[buf_size] = '\0';
+	num = sscanf(buf, "%2s %u %u %u", dir, &ch, &bd, &wd);
+	if (!(num == 4 && !strcmp(dir, "tx")) && !(num == 3 && !strcmp(dir, "rx"))) {
+		rtw89_info(rtwdev, "invalid format: tx <ch> <bd> <wd> | rx <ch> <bd>\n");
+		return -EINVAL;
+	}
+
+	mutex_lock(&rtwdev->mutex);
+	ret = rtwdev->hci.ops->set_rings(rtwdev, dir[0] == 't', ch, bd, wd);
+	mutex_unlock(&rtwdev->mutex);
+
+	return ret ? ret : count;
+}
+
 #define DM_INFO(type) {RTW89_DM_ ## type, #type}
 
 static const struct rtw89_disabled_dm_info {
@@ -3920,6 +4303,46 @@ static struct rtw89_debugfs_priv rtw89_debug_priv_disable_dm = {
 	.cb_write = rtw89_debug_priv_disable_dm_set,
 };
 
+static struct rtw89_debugfs_priv rtw89_debug_priv_txq_stats = {
+	.cb_read = rtw89_debug_priv_txq_stats_get,
+};
+
+static struct rtw89_debugfs_priv rtw89_debug_priv_tx_desc_stats = {
+	.cb_read = rtw89_debug_priv_tx_desc_stats_get,
+	.cb_write = rtw89_debug_priv_tx_desc_stats_set,
+};
+
+static struct rtw89_debugfs_priv rtw89_debug_priv_track_stats = {
+	.cb_read = rtw89_debug_priv_track_stats_get,
+};
+
+static struct rtw89_debugfs_priv rtw89_debug_priv_tx_latency = {
+	.cb_read = rtw89_debug_priv_tx_latency_get,
+	.cb_write = rtw89_debug_priv_tx_latency_set,
+};
+
+static struct rtw89_debugfs_priv rtw89_debug_priv_ppdu_sts = {
+	.cb_read = rtw89_debug_priv_ppdu_sts_get,
+};
+
+static struct rtw89_debugfs_priv rtw89_debug_priv_reg_shadow = {
+	.cb_read = rtw89_debug_priv_reg_shadow_get,
+};
+
+static struct rtw89_debugfs_priv rtw89_debug_priv_pci_stats = {
+	.cb_read = rtw89_debug_priv_pci_stats_get,
+};
+
+static struct rtw89_debugfs_priv rtw89_debug_priv_pci_rx_mit = {
+	.cb_read = rtw89_debug_priv_pci_rx_mit_get,
+	.cb_write = rtw89_debug_priv_pci_rx_mit_set,
+};
+
+static struct rtw89_debugfs_priv rtw89_debug_priv_pci_rings = {
+	.cb_read = rtw89_debug_priv_pci_rings_get,
+	.cb_write = rtw89_debug_priv_pci_rings_set,
+};
+
 #define rtw89_debugfs_add(name, mode, fopname, parent)				\
 	do {									\
 		rtw89_debug_priv_ ##name.rtwdev = rtwdev;			\
@@ -3961,6 +4384,15 @@ void rtw89_debugfs_init(struct rtw89_dev *rtwdev)
 	rtw89_debugfs_add_r(phy_info);
 	rtw89_debugfs_add_r(stations);
 	rtw89_debugfs_add_rw(disable_dm);
+	rtw89_debugfs_add_r(txq_stats);
+	rtw89_debugfs_add_rw(tx_desc_stats);
+	rtw89_debugfs_add_r(track_stats);
+	rtw89_debugfs_add_r(ppdu_sts);
+	rtw89_debugfs_add_rw(tx_latency);
+	rtw89_debugfs_add_r(reg_shadow);
+	rtw89_debugfs_add_r(pci_stats);
+	rtw89_debugfs_add_rw(pci_rx_mit);
+	rtw89_debugfs_add_rw(pci_rings);
 }
 #endif
 
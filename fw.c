@@ -12,6 +12,7 @@
 #include "phy.h"
 #include "ps.h"
 #include "reg.h"
+#include "trace.h"
 #include "util.h"
 
 struct rtw89_eapol_2_of_2 {
@@ -5625,6 +5626,7 @@ static bool rtw89_fw_c2h_chk_atomic(struct rtw89_dev *rtwdev,
 void rtw89_fw_c2h_irqsafe(struct rtw89_dev *rtwdev, struct sk_buff *c2h)
 {
 	rtw89_fw_c2h_parse_attr(c2h);
+	trace_rtw89_fw_c2h(rtwdev, RTW89_SKB_C2H_CB(c2h));
 	if (!rtw89_fw_c2h_chk_atomic(rtwdev, c2h))
 		goto enqueue;
 
@@ -1471,6 +1471,9 @@ static int rtw89_mac_power_switch(struct rtw89_dev *rtwdev, bool on)
 	if (ret)
 		return ret;
 
+	/* registers are back to their reset values */
+	rtw89_reg_shadow_invalidate(rtwdev);
+
 	if (on) {
 		set_bit(RTW89_FLAG_POWERON, rtwdev->flags);
 		set_bit(RTW89_FLAG_DMAC_FUNC, rtwdev->flags);
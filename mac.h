@@ -1191,8 +1191,13 @@ static inline
 int rtw89_mac_cfg_ppdu_status(struct rtw89_dev *rtwdev, u8 mac_idx, bool enable)
 {
 	const struct rtw89_mac_gen_def *mac = rtwdev->chip->mac_def;
+	int ret;
+
+	ret = mac->cfg_ppdu_status(rtwdev, mac_idx, enable);
+	if (mac_idx < RTW89_PHY_MAX)
+		WRITE_ONCE(rtwdev->ppdu_sts.enabled[mac_idx], enable && !ret);
 
-	return mac->cfg_ppdu_status(rtwdev, mac_idx, enable);
+	return ret;
 }
 
 void rtw89_mac_update_rts_threshold(struct rtw89_dev *rtwdev, u8 mac_idx);
@@ -50,8 +50,7 @@ static void rtw89_ops_wake_tx_queue(struct ieee80211_hw *hw,
 {
 	struct rtw89_dev *rtwdev = hw->priv;
 
-	ieee80211_schedule_txq(hw, txq);
-	queue_work(rtwdev->txq_wq, &rtwdev->txq_work);
+	rtw89_core_txq_wake(rtwdev, txq);
 }
 
 static int rtw89_ops_start(struct ieee80211_hw *hw)
@@ -131,13 +130,19 @@ static int rtw89_ops_add_interface(struct ieee80211_hw *hw,
 	INIT_DELAYED_WORK(&rtwvif->roc.roc_work, rtw89_roc_work);
 	rtw89_leave_ps_mode(rtwdev);
 
-	rtw89_traffic_stats_init(rtwdev, &rtwvif->stats);
+	ret = rtw89_traffic_stats_init(rtwdev, &rtwvif->stats);
+	if (ret) {
+		list_del_init(&rtwvif->list);
+		goto out;
+	}
+
 	rtw89_vif_type_mapping(vif, false);
 	rtwvif->port = rtw89_core_acquire_bit_map(rtwdev->hw_port,
 						  RTW89_PORT_NUM);
 	if (rtwvif->port == RTW89_PORT_NUM) {
 		ret = -ENOSPC;
 		list_del_init(&rtwvif->list);
+		rtw89_traffic_stats_deinit(&rtwvif->stats);
 		goto out;
 	}
 
@@ -155,6 +160,7 @@ static int rtw89_ops_add_interface(struct ieee80211_hw *hw,
 	if (ret) {
 		rtw89_core_release_bit_map(rtwdev->hw_port, rtwvif->port);
 		list_del_init(&rtwvif->list);
+		rtw89_traffic_stats_deinit(&rtwvif->stats);
 		goto out;
 	}
 
@@ -187,6 +193,10 @@ static void rtw89_ops_remove_interface(struct ieee80211_hw *hw,
 	rtw89_mac_remove_vif(rtwdev, rtwvif);
 	rtw89_core_release_bit_map(rtwdev->hw_port, rtwvif->port);
 	list_del_init(&rtwvif->list);
+	rtw89_core_txq_deinit(rtwdev, vif->txq);
+	/* RX NAPI and TX account to the vif under RCU until they see it gone */
+	synchronize_net();
+	rtw89_traffic_stats_deinit(&rtwvif->stats);
 	rtw89_recalc_lps(rtwdev);
 	rtw89_enter_ips_by_hwflags(rtwdev);
 
@@ -628,6 +638,7 @@ static int rtw89_ops_sta_state(struct ieee80211_hw *hw,
 	mutex_lock(&rtwdev->mutex);
 	rtw89_leave_ps_mode(rtwdev);
 	ret = __rtw89_ops_sta_state(hw, vif, sta, old_state, new_state);
+	rtw89_core_tx_tmpl_invalidate(rtwdev);
 	mutex_unlock(&rtwdev->mutex);
 
 	return ret;
@@ -654,8 +665,11 @@ static int rtw89_ops_set_key(struct ieee80211_hw *hw, enum set_key_cmd cmd,
 		}
 		break;
 	case DISABLE_KEY:
+		/* set_key runs under the mutex, so don't wait as long as
+		 * a flush from mac80211
+		 */
 		rtw89_hci_flush_queues(rtwdev, BIT(rtwdev->hw->queues) - 1,
-				       false);
+				       RTW89_FLUSH_SHORT);
 		rtw89_mac_flush_txq(rtwdev, BIT(rtwdev->hw->queues) - 1, false);
 		ret = rtw89_cam_sec_key_del(rtwdev, vif, sta, key, true);
 		if (ret) {
@@ -666,6 +680,7 @@ static int rtw89_ops_set_key(struct ieee80211_hw *hw, enum set_key_cmd cmd,
 	}
 
 out:
+	rtw89_core_tx_tmpl_invalidate(rtwdev);
 	mutex_unlock(&rtwdev->mutex);
 
 	return ret;
@@ -697,6 +712,7 @@ static int rtw89_ops_ampdu_action(struct ieee80211_hw *hw,
 		clear_bit(RTW89_TXQ_F_AMPDU, &rtwtxq->flags);
 		clear_bit(tid, rtwsta->ampdu_map);
 		rtw89_chip_h2c_ampdu_cmac_tbl(rtwdev, vif, sta);
+		rtw89_core_tx_tmpl_invalidate(rtwdev);
 		mutex_unlock(&rtwdev->mutex);
 		ieee80211_stop_tx_ba_cb_irqsafe(vif, sta->addr, tid);
 		break;
@@ -708,6 +724,7 @@ static int rtw89_ops_ampdu_action(struct ieee80211_hw *hw,
 		set_bit(tid, rtwsta->ampdu_map);
 		rtw89_leave_ps_mode(rtwdev);
 		rtw89_chip_h2c_ampdu_cmac_tbl(rtwdev, vif, sta);
+		rtw89_core_tx_tmpl_invalidate(rtwdev);
 		mutex_unlock(&rtwdev->mutex);
 		break;
 	case IEEE80211_AMPDU_RX_START:
@@ -773,7 +790,8 @@ static void rtw89_ops_flush(struct ieee80211_hw *hw, struct ieee80211_vif *vif,
 
 	mutex_lock(&rtwdev->mutex);
 	rtw89_leave_lps(rtwdev);
-	rtw89_hci_flush_queues(rtwdev, queues, drop);
+	rtw89_hci_flush_queues(rtwdev, queues,
+			       drop ? RTW89_FLUSH_DROP : RTW89_FLUSH_WAIT);
 
 	if (drop && !RTW89_CHK_FW_FEATURE(NO_PACKET_DROP, &rtwdev->fw))
 		__rtw89_drop_packets(rtwdev, vif);
@@ -824,6 +842,7 @@ static int rtw89_ops_set_bitrate_mask(struct ieee80211_hw *hw,
 	mutex_lock(&rtwdev->mutex);
 	rtw89_phy_rate_pattern_vif(rtwdev, vif, mask);
 	rtw89_ra_mask_info_update(rtwdev, vif, mask);
+	rtw89_core_tx_tmpl_invalidate(rtwdev);
 	mutex_unlock(&rtwdev->mutex);
 
 	return 0;
@@ -943,6 +962,8 @@ static void rtw89_ops_sta_rc_update(struct ieee80211_hw *hw,
 	struct rtw89_dev *rtwdev = hw->priv;
 
 	rtw89_phy_ra_updata_sta(rtwdev, sta, changed);
+	/* lowest retry rate of the templates comes from supported rates */
+	rtw89_core_tx_tmpl_invalidate(rtwdev);
 }
 
 static int rtw89_ops_add_chanctx(struct ieee80211_hw *hw,
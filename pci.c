@@ -3,21 +3,45 @@
  */
 
 #include <linux/pci.h>
+#include <linux/prefetch.h>
+#include <linux/seq_file.h>
 
 #include "mac.h"
 #include "pci.h"
 #include "reg.h"
 #include "ser.h"
+#include "trace.h"
+
+#ifdef RTW89_PCI_RX_PAGE_POOL
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 6, 0)
+#include <net/page_pool/helpers.h>
+#else
+#include <net/page_pool.h>
+#endif
+#endif
 
 static bool rtw89_pci_disable_clkreq;
 static bool rtw89_pci_disable_aspm_l1;
 static bool rtw89_pci_disable_l1ss;
+static bool rtw89_pci_disable_rx_zc;
 module_param_named(disable_clkreq, rtw89_pci_disable_clkreq, bool, 0644);
 module_param_named(disable_aspm_l1, rtw89_pci_disable_aspm_l1, bool, 0644);
 module_param_named(disable_aspm_l1ss, rtw89_pci_disable_l1ss, bool, 0644);
+module_param_named(disable_rx_zero_copy, rtw89_pci_disable_rx_zc, bool, 0444);
 MODULE_PARM_DESC(disable_clkreq, "Set Y to disable PCI clkreq support");
 MODULE_PARM_DESC(disable_aspm_l1, "Set Y to disable PCI ASPM L1 support");
 MODULE_PARM_DESC(disable_aspm_l1ss, "Set Y to disable PCI L1SS support");
+MODULE_PARM_DESC(disable_rx_zero_copy, "Set Y to always copy RX frames out of the RX ring");
+
+static ushort rtw89_pci_txbd_num[RTW89_TXCH_NUM];
+static ushort rtw89_pci_txwd_num[RTW89_TXCH_NUM];
+static ushort rtw89_pci_rxbd_num[RTW89_RXCH_NUM];
+module_param_array_named(txbd_num, rtw89_pci_txbd_num, ushort, NULL, 0444);
+module_param_array_named(txwd_num, rtw89_pci_txwd_num, ushort, NULL, 0444);
+module_param_array_named(rxbd_num, rtw89_pci_rxbd_num, ushort, NULL, 0444);
+MODULE_PARM_DESC(txbd_num, "Number of TX BDs of each TX channel, 0 for default");
+MODULE_PARM_DESC(txwd_num, "Number of TX WD pages of each TX channel, 0 for default");
+MODULE_PARM_DESC(rxbd_num, "Number of RX BDs of each RX channel, 0 for default");
 
 static int rtw89_pci_get_phy_offset_by_link_speed(struct rtw89_dev *rtwdev,
 						  u32 *phy_offset)
@@ -97,6 +121,38 @@ static u32 rtw89_pci_txbd_recalc(struct rtw89_dev *rtwdev,
 	return cnt;
 }
 
+static void rtw89_pci_spin_lock_bh(spinlock_t *lock, u64 *acquired,
+				   u64 *contended)
+{
+	if (!spin_trylock_bh(lock)) {
+		spin_lock_bh(lock);
+		(*contended)++;
+	}
+	(*acquired)++;
+}
+
+static void rtw89_pci_tx_ring_lock(struct rtw89_pci_tx_ring *tx_ring)
+{
+	rtw89_pci_spin_lock_bh(&tx_ring->lock, &tx_ring->lock_acquired,
+			       &tx_ring->lock_contended);
+}
+
+static void rtw89_pci_tx_ring_unlock(struct rtw89_pci_tx_ring *tx_ring)
+{
+	spin_unlock_bh(&tx_ring->lock);
+}
+
+static void rtw89_pci_rpq_lock(struct rtw89_pci *rtwpci)
+{
+	rtw89_pci_spin_lock_bh(&rtwpci->rpq_lock, &rtwpci->rpq_lock_acquired,
+			       &rtwpci->rpq_lock_contended);
+}
+
+static void rtw89_pci_rpq_unlock(struct rtw89_pci *rtwpci)
+{
+	spin_unlock_bh(&rtwpci->rpq_lock);
+}
+
 static void rtw89_pci_release_fwcmd(struct rtw89_dev *rtwdev,
 				    struct rtw89_pci *rtwpci,
 				    u32 cnt, bool release_all)
@@ -156,16 +212,28 @@ static u32 rtw89_pci_rxbd_recalc(struct rtw89_dev *rtwdev,
 	return cnt;
 }
 
+/* Length of RX buffer written by device, including RXBD info. CPU reads
+ * no further, so only this part is synced in both directions.
+ */
+static u32 rtw89_pci_rx_sync_len(struct sk_buff *skb)
+{
+	struct rtw89_pci_rx_info *rx_info = RTW89_PCI_RX_SKB_CB(skb);
+
+	return clamp_t(u32, rx_info->len, sizeof(struct rtw89_pci_rxbd_info),
+		       RTW89_PCI_RX_BUF_SIZE);
+}
+
 static void rtw89_pci_sync_skb_for_cpu(struct rtw89_dev *rtwdev,
-				       struct sk_buff *skb)
+				       struct sk_buff *skb,
+				       u32 offset, u32 len)
 {
 	struct rtw89_pci_rx_info *rx_info;
 	dma_addr_t dma;
 
 	rx_info = RTW89_PCI_RX_SKB_CB(skb);
 	dma = rx_info->dma;
-	dma_sync_single_for_cpu(rtwdev->dev, dma, RTW89_PCI_RX_BUF_SIZE,
-				DMA_FROM_DEVICE);
+	dma_sync_single_range_for_cpu(rtwdev->dev, dma, offset, len,
+				      DMA_FROM_DEVICE);
 }
 
 static void rtw89_pci_sync_skb_for_device(struct rtw89_dev *rtwdev,
@@ -176,7 +244,7 @@ static void rtw89_pci_sync_skb_for_device(struct rtw89_dev *rtwdev,
 
 	rx_info = RTW89_PCI_RX_SKB_CB(skb);
 	dma = rx_info->dma;
-	dma_sync_single_for_device(rtwdev->dev, dma, RTW89_PCI_RX_BUF_SIZE,
+	dma_sync_single_for_device(rtwdev->dev, dma, rtw89_pci_rx_sync_len(skb),
 				   DMA_FROM_DEVICE);
 }
 
@@ -225,11 +293,13 @@ int rtw89_pci_sync_skb_for_device_and_validate_rx_info(struct rtw89_dev *rtwdev,
 						       struct sk_buff *skb)
 {
 	struct rtw89_pci_rx_info *rx_info = RTW89_PCI_RX_SKB_CB(skb);
+	u32 rxinfo_size = sizeof(struct rtw89_pci_rxbd_info);
 	int rx_tag_retry = 100;
+	u32 len;
 	int ret;
 
 	do {
-		rtw89_pci_sync_skb_for_cpu(rtwdev, skb);
+		rtw89_pci_sync_skb_for_cpu(rtwdev, skb, 0, rxinfo_size);
 		rtw89_pci_rxbd_info_update(rtwdev, skb);
 
 		ret = rtw89_pci_validate_rx_tag(rtwdev, rx_ring, skb);
@@ -237,6 +307,12 @@ int rtw89_pci_sync_skb_for_device_and_validate_rx_info(struct rtw89_dev *rtwdev,
 			break;
 	} while (rx_tag_retry--);
 
+	/* RXBD info tells the length, then sync the rest of written data */
+	len = rtw89_pci_rx_sync_len(skb);
+	if (len > rxinfo_size)
+		rtw89_pci_sync_skb_for_cpu(rtwdev, skb, rxinfo_size,
+					   len - rxinfo_size);
+
 	/* update target rx_tag for next RX */
 	rx_ring->target_rx_tag = rx_info->tag + 1;
 
@@ -315,6 +391,149 @@ static u32 rtw89_pci_get_rx_skb_idx(struct rtw89_dev *rtwdev,
 	return wp;
 }
 
+static void rtw89_pci_fill_rx_bd(struct rtw89_pci_rx_ring *rx_ring, u32 idx,
+				 dma_addr_t dma, u32 buf_sz)
+{
+	struct rtw89_pci_rx_bd_32 *rx_bd = RTW89_PCI_RX_BD(rx_ring, idx);
+
+	memset(rx_bd, 0, sizeof(*rx_bd));
+	rx_bd->buf_size = cpu_to_le16(buf_sz);
+	rx_bd->dma = cpu_to_le32(dma);
+}
+
+#ifdef RTW89_PCI_RX_PAGE_POOL
+static u32 rtw89_pci_rx_zc_truesize(u32 buf_sz)
+{
+	return SKB_DATA_ALIGN(RTW89_PCI_RX_ZC_HEADROOM + buf_sz) +
+	       SKB_DATA_ALIGN(sizeof(struct skb_shared_info));
+}
+
+static struct sk_buff *rtw89_pci_rx_zc_alloc_skb(struct rtw89_pci_rx_ring *rx_ring,
+						 gfp_t gfp)
+{
+	unsigned int order = get_order(rtw89_pci_rx_zc_truesize(rx_ring->buf_sz));
+	struct page_pool *pool = rx_ring->page_pool;
+	struct rtw89_pci_rx_info *rx_info;
+	struct sk_buff *skb;
+	struct page *page;
+
+	page = page_pool_alloc_pages(pool, gfp | __GFP_NOWARN);
+	if (!page)
+		return NULL;
+
+	skb = build_skb(page_address(page), PAGE_SIZE << order);
+	if (!skb) {
+		page_pool_put_full_page(pool, page, false);
+		return NULL;
+	}
+
+	skb_reserve(skb, RTW89_PCI_RX_ZC_HEADROOM);
+	skb_mark_for_recycle(skb);
+
+	rx_info = RTW89_PCI_RX_SKB_CB(skb);
+	rx_info->dma = page_pool_get_dma_addr(page) + RTW89_PCI_RX_ZC_HEADROOM;
+
+	return skb;
+}
+
+static int rtw89_pci_rx_zc_init(struct rtw89_dev *rtwdev, struct pci_dev *pdev,
+				struct rtw89_pci_rx_ring *rx_ring, u32 len)
+{
+	struct page_pool_params pp_params = {};
+	struct page_pool *pool;
+
+	pp_params.order = get_order(rtw89_pci_rx_zc_truesize(rx_ring->buf_sz));
+	pp_params.flags = PP_FLAG_DMA_MAP;
+	pp_params.pool_size = len;
+	pp_params.nid = dev_to_node(&pdev->dev);
+	pp_params.dev = &pdev->dev;
+	pp_params.dma_dir = DMA_FROM_DEVICE;
+
+	pool = page_pool_create(&pp_params);
+	if (IS_ERR(pool))
+		return PTR_ERR(pool);
+
+	rx_ring->page_pool = pool;
+
+	return 0;
+}
+
+static void rtw89_pci_rx_zc_deinit(struct rtw89_pci_rx_ring *rx_ring)
+{
+	if (!rx_ring->page_pool)
+		return;
+
+	page_pool_destroy(rx_ring->page_pool);
+	rx_ring->page_pool = NULL;
+}
+#else
+static struct sk_buff *rtw89_pci_rx_zc_alloc_skb(struct rtw89_pci_rx_ring *rx_ring,
+						 gfp_t gfp)
+{
+	return NULL;
+}
+
+static int rtw89_pci_rx_zc_init(struct rtw89_dev *rtwdev, struct pci_dev *pdev,
+				struct rtw89_pci_rx_ring *rx_ring, u32 len)
+{
+	return -EOPNOTSUPP;
+}
+
+static void rtw89_pci_rx_zc_deinit(struct rtw89_pci_rx_ring *rx_ring) {}
+#endif
+
+/* Hand a single-segment frame up with the ring buffer itself, and put a
+ * fresh buffer from the page pool into the slot. Return false to let the
+ * caller fall back to copying.
+ */
+static bool rtw89_pci_rxbd_deliver_zc(struct rtw89_dev *rtwdev,
+				      struct rtw89_pci_rx_ring *rx_ring,
+				      struct sk_buff *skb, u32 skb_idx, u32 offset)
+{
+	struct rtw89_pci_rx_info *rx_info = RTW89_PCI_RX_SKB_CB(skb);
+	struct rtw89_rx_desc_info *desc_info = &rx_ring->diliver_desc;
+	struct rtw89_pci_rx_info *new_info;
+	struct sk_buff *new;
+
+	if (!rx_ring->page_pool || !desc_info->ready)
+		return false;
+
+	/* radiotap header needs more headroom than ring buffer reserves */
+	if (rtwdev->hw->conf.flags & IEEE80211_CONF_MONITOR)
+		return false;
+
+	if (desc_info->pkt_size < RTW89_PCI_RX_COPYBREAK)
+		return false;
+
+	/* leave invalid length to copy path which can dump and trim it */
+	if (rx_info->len > rx_ring->buf_sz || offset > rx_info->len ||
+	    rx_info->len - offset > desc_info->pkt_size)
+		return false;
+
+	new = rtw89_pci_rx_zc_alloc_skb(rx_ring, GFP_ATOMIC);
+	if (!new) {
+		rx_ring->rx_zc_alloc_fail++;
+		return false;
+	}
+
+	new_info = RTW89_PCI_RX_SKB_CB(new);
+	dma_sync_single_for_device(rtwdev->dev, new_info->dma, rx_ring->buf_sz,
+				   DMA_FROM_DEVICE);
+	rtw89_pci_fill_rx_bd(rx_ring, skb_idx, new_info->dma, rx_ring->buf_sz);
+	rx_ring->buf[skb_idx] = new;
+	rtw89_pci_rxbd_increase(rx_ring, 1);
+
+	skb_put(skb, rx_info->len);
+	skb_pull(skb, offset);
+	rx_ring->rx_zc_cnt++;
+	rx_ring->rx_bytes += skb->len;
+
+	rtw89_core_rx(rtwdev, desc_info, skb);
+	desc_info->ready = false;
+
+	return true;
+}
+
 static u32 rtw89_pci_rxbd_deliver_skbs(struct rtw89_dev *rtwdev,
 				       struct rtw89_pci_rx_ring *rx_ring)
 {
@@ -343,6 +562,7 @@ static u32 rtw89_pci_rxbd_deliver_skbs(struct rtw89_dev *rtwdev,
 	rx_info = RTW89_PCI_RX_SKB_CB(skb);
 	fs = rx_info->fs;
 	ls = rx_info->ls;
+	trace_rtw89_pci_rxbd_deliver(rtwdev, skb_idx, rx_info->len, fs, ls);
 
 	if (fs) {
 		if (new) {
@@ -357,14 +577,18 @@ static u32 rtw89_pci_rxbd_deliver_skbs(struct rtw89_dev *rtwdev,
 
 		rtw89_chip_query_rxdesc(rtwdev, desc_info, skb->data, rxinfo_size);
 
+		/* first segment has RX desc */
+		offset = desc_info->offset + desc_info->rxd_len;
+
+		if (ls && rtw89_pci_rxbd_deliver_zc(rtwdev, rx_ring, skb,
+						    skb_idx, offset))
+			return cnt;
+
 		new = rtw89_alloc_skb_for_rx(rtwdev, desc_info->pkt_size);
 		if (!new)
 			goto err_sync_device;
 
 		rx_ring->diliver_skb = new;
-
-		/* first segment has RX desc */
-		offset = desc_info->offset + desc_info->rxd_len;
 	} else {
 		offset = sizeof(struct rtw89_pci_rxbd_info);
 		if (!new) {
@@ -382,6 +606,8 @@ static u32 rtw89_pci_rxbd_deliver_skbs(struct rtw89_dev *rtwdev,
 		goto err_free_resource;
 	}
 	if (ls) {
+		rx_ring->rx_copy_cnt++;
+		rx_ring->rx_bytes += new->len;
 		rtw89_core_rx(rtwdev, desc_info, new);
 		rx_ring->diliver_skb = NULL;
 		desc_info->ready = false;
@@ -437,6 +663,8 @@ static int rtw89_pci_poll_rxq_dma(struct rtw89_dev *rtwdev,
 	if (!cnt)
 		return 0;
 
+	rx_ring->bd_hwm = max(rx_ring->bd_hwm, cnt);
+
 	cnt = min_t(u32, budget, cnt);
 
 	rtw89_pci_rxbd_deliver(rtwdev, rx_ring, cnt);
@@ -445,12 +673,16 @@ static int rtw89_pci_poll_rxq_dma(struct rtw89_dev *rtwdev,
 	if (rtwdev->napi_budget_countdown <= 0)
 		return budget;
 
-	return budget - countdown;
+	return countdown - rtwdev->napi_budget_countdown;
 }
 
+/* Fill TX status of skb and queue it to @done, which is reported by
+ * rtw89_pci_tx_status_report() after locks of TX rings are released.
+ */
 static void rtw89_pci_tx_status(struct rtw89_dev *rtwdev,
 				struct rtw89_pci_tx_ring *tx_ring,
-				struct sk_buff *skb, u8 tx_status)
+				struct sk_buff *skb, u8 tx_status,
+				struct sk_buff_head *done)
 {
 	struct rtw89_tx_skb_data *skb_data = RTW89_TX_SKB_CB(skb);
 	struct ieee80211_tx_info *info;
@@ -485,7 +717,60 @@ static void rtw89_pci_tx_status(struct rtw89_dev *rtwdev,
 		}
 	}
 
-	ieee80211_tx_status_ni(rtwdev->hw, skb);
+	__skb_queue_tail(done, skb);
+}
+
+static void rtw89_pci_tx_status_report(struct rtw89_dev *rtwdev,
+				       struct sk_buff_head *done)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	struct sk_buff *skb;
+
+	if (skb_queue_empty(done))
+		return;
+
+	local_bh_disable();
+	while ((skb = __skb_dequeue(done))) {
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 7, 0)
+		ieee80211_tx_status_skb(rtwdev->hw, skb);
+#else
+		ieee80211_tx_status(rtwdev->hw, skb);
+#endif
+	}
+	local_bh_enable();
+
+	if (wq_has_sleeper(&rtwpci->flush_wq))
+		wake_up(&rtwpci->flush_wq);
+}
+
+static void rtw89_pci_push_busy_txwd(struct rtw89_pci_tx_wd_ring *wd_ring,
+				     struct rtw89_pci_tx_wd *txwd)
+{
+	u32 idx = wd_ring->busy_head + wd_ring->busy_num;
+
+	if (idx >= wd_ring->page_num)
+		idx -= wd_ring->page_num;
+
+	wd_ring->busy_fifo[idx] = txwd->seq;
+	wd_ring->busy_num++;
+	txwd->queued = true;
+}
+
+static struct rtw89_pci_tx_wd *
+rtw89_pci_pop_busy_txwd(struct rtw89_pci_tx_wd_ring *wd_ring)
+{
+	struct rtw89_pci_tx_wd *txwd;
+
+	if (!wd_ring->busy_num)
+		return NULL;
+
+	txwd = &wd_ring->pages[wd_ring->busy_fifo[wd_ring->busy_head]];
+	if (++wd_ring->busy_head >= wd_ring->page_num)
+		wd_ring->busy_head = 0;
+	wd_ring->busy_num--;
+	txwd->queued = false;
+
+	return txwd;
 }
 
 static void rtw89_pci_reclaim_txbd(struct rtw89_dev *rtwdev, struct rtw89_pci_tx_ring *tx_ring)
@@ -495,14 +780,12 @@ static void rtw89_pci_reclaim_txbd(struct rtw89_dev *rtwdev, struct rtw89_pci_tx
 
 	cnt = rtw89_pci_txbd_recalc(rtwdev, tx_ring);
 	while (cnt--) {
-		txwd = list_first_entry_or_null(&tx_ring->busy_pages, struct rtw89_pci_tx_wd, list);
+		txwd = rtw89_pci_pop_busy_txwd(&tx_ring->wd_ring);
 		if (!txwd) {
 			rtw89_warn(rtwdev, "No busy txwd pages available\n");
 			break;
 		}
 
-		list_del_init(&txwd->list);
-
 		/* this skb has been freed by RPP */
 		if (skb_queue_len(&txwd->queue) == 0)
 			rtw89_pci_enqueue_txwd(tx_ring, txwd);
@@ -513,34 +796,57 @@ static void rtw89_pci_release_busy_txwd(struct rtw89_dev *rtwdev,
 					struct rtw89_pci_tx_ring *tx_ring)
 {
 	struct rtw89_pci_tx_wd_ring *wd_ring = &tx_ring->wd_ring;
-	struct rtw89_pci_tx_wd *txwd;
-	int i;
 
-	for (i = 0; i < wd_ring->page_num; i++) {
-		txwd = list_first_entry_or_null(&tx_ring->busy_pages, struct rtw89_pci_tx_wd, list);
-		if (!txwd)
-			break;
+	while (rtw89_pci_pop_busy_txwd(wd_ring))
+		;
+	tx_ring->unkicked = 0;
+}
 
-		list_del_init(&txwd->list);
+static void rtw89_pci_tx_unmap_segs(struct device *dev,
+				    struct rtw89_pci_tx_seg *segs, u8 nr_segs)
+{
+	u8 i;
+
+	for (i = 0; i < nr_segs; i++) {
+		if (segs[i].page)
+			dma_unmap_page(dev, segs[i].dma, segs[i].len, DMA_TO_DEVICE);
+		else
+			dma_unmap_single(dev, segs[i].dma, segs[i].len, DMA_TO_DEVICE);
+	}
+}
+
+static void rtw89_pci_txwd_unmap_skb(struct rtw89_pci *rtwpci,
+				     struct rtw89_pci_tx_wd *txwd,
+				     struct sk_buff *skb)
+{
+	struct rtw89_pci_tx_data *tx_data = RTW89_PCI_TX_SKB_CB(skb);
+
+	if (txwd->nr_segs) {
+		rtw89_pci_tx_unmap_segs(&rtwpci->pdev->dev, txwd->segs,
+					txwd->nr_segs);
+		txwd->nr_segs = 0;
+		return;
 	}
+
+	dma_unmap_single(&rtwpci->pdev->dev, tx_data->dma, skb->len,
+			 DMA_TO_DEVICE);
 }
 
 static void rtw89_pci_release_txwd_skb(struct rtw89_dev *rtwdev,
 				       struct rtw89_pci_tx_ring *tx_ring,
 				       struct rtw89_pci_tx_wd *txwd, u16 seq,
-				       u8 tx_status)
+				       u8 tx_status, struct sk_buff_head *done)
 {
 	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
-	struct rtw89_pci_tx_data *tx_data;
 	struct sk_buff *skb, *tmp;
 	u8 txch = tx_ring->txch;
 
-	if (!list_empty(&txwd->list)) {
+	if (txwd->queued) {
 		rtw89_pci_reclaim_txbd(rtwdev, tx_ring);
 		/* In low power mode, RPP can receive before updating of TX BD.
 		 * In normal mode, it should not happen so give it a warning.
 		 */
-		if (!rtwpci->low_power && !list_empty(&txwd->list))
+		if (!rtwpci->low_power && txwd->queued)
 			rtw89_warn(rtwdev, "queue %d txwd %d is not idle\n",
 				   txch, seq);
 	}
@@ -548,46 +854,95 @@ static void rtw89_pci_release_txwd_skb(struct rtw89_dev *rtwdev,
 	skb_queue_walk_safe(&txwd->queue, skb, tmp) {
 		skb_unlink(skb, &txwd->queue);
 
-		tx_data = RTW89_PCI_TX_SKB_CB(skb);
-		dma_unmap_single(&rtwpci->pdev->dev, tx_data->dma, skb->len,
-				 DMA_TO_DEVICE);
+		rtw89_pci_txwd_unmap_skb(rtwpci, txwd, skb);
 
-		rtw89_pci_tx_status(rtwdev, tx_ring, skb, tx_status);
+		rtw89_pci_tx_status(rtwdev, tx_ring, skb, tx_status, done);
 	}
 
-	if (list_empty(&txwd->list))
+	if (!txwd->queued)
 		rtw89_pci_enqueue_txwd(tx_ring, txwd);
 }
 
-static void rtw89_pci_release_rpp(struct rtw89_dev *rtwdev,
-				  struct rtw89_pci_rpp_fmt *rpp)
+static struct rtw89_pci_tx_ring *
+rtw89_pci_rpp_tx_ring(struct rtw89_dev *rtwdev, struct rtw89_pci_rpp_fmt *rpp)
 {
 	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	u8 qsel, txch;
+
+	qsel = le32_get_bits(rpp->dword, RTW89_PCI_RPP_QSEL);
+	txch = rtw89_core_get_ch_dma(rtwdev, qsel);
+	if (txch == RTW89_TXCH_CH12)
+		return NULL;
+
+	return &rtwpci->tx_rings[txch];
+}
+
+static void rtw89_pci_prefetch_rpp(struct rtw89_dev *rtwdev,
+				   struct rtw89_pci_rpp_fmt *rpp)
+{
+	struct rtw89_pci_tx_ring *tx_ring = rtw89_pci_rpp_tx_ring(rtwdev, rpp);
+	u16 seq = le32_get_bits(rpp->dword, RTW89_PCI_RPP_SEQ);
+
+	if (tx_ring && seq < tx_ring->wd_ring.page_num)
+		prefetch(&tx_ring->wd_ring.pages[seq]);
+}
+
+/* Consecutive reports of the same TX ring are released under one lock,
+ * which is left held in @locked for the next report.
+ */
+static void rtw89_pci_release_rpp(struct rtw89_dev *rtwdev,
+				  struct rtw89_pci_rpp_fmt *rpp,
+				  struct rtw89_pci_tx_ring **locked,
+				  struct sk_buff_head *done)
+{
 	struct rtw89_pci_tx_ring *tx_ring;
 	struct rtw89_pci_tx_wd_ring *wd_ring;
 	struct rtw89_pci_tx_wd *txwd;
 	u16 seq;
-	u8 qsel, tx_status, txch;
+	u8 tx_status;
 
 	seq = le32_get_bits(rpp->dword, RTW89_PCI_RPP_SEQ);
-	qsel = le32_get_bits(rpp->dword, RTW89_PCI_RPP_QSEL);
 	tx_status = le32_get_bits(rpp->dword, RTW89_PCI_RPP_TX_STATUS);
-	txch = rtw89_core_get_ch_dma(rtwdev, qsel);
 
-	if (txch == RTW89_TXCH_CH12) {
+	tx_ring = rtw89_pci_rpp_tx_ring(rtwdev, rpp);
+	if (!tx_ring) {
 		rtw89_warn(rtwdev, "should no fwcmd release report\n");
 		return;
 	}
 
-	tx_ring = &rtwpci->tx_rings[txch];
 	wd_ring = &tx_ring->wd_ring;
+	if (unlikely(seq >= wd_ring->page_num)) {
+		rtw89_warn(rtwdev, "invalid release report seq %u\n", seq);
+		return;
+	}
+
 	txwd = &wd_ring->pages[seq];
+	trace_rtw89_pci_release_rpp(rtwdev, tx_ring->txch, seq, tx_status);
+
+	if (unlikely(txwd->enqueue_ts)) {
+		rtw89_core_tx_lat_report(rtwdev, txwd->mac_id, txwd->ac,
+					 txwd->enqueue_ts, txwd->kick_ts);
+		txwd->enqueue_ts = 0;
+	}
+
+	rtw89_core_tx_airtime_report(rtwdev, txwd->mac_id, txwd->tid,
+				     txwd->airtime_len,
+				     tx_status == RTW89_TX_DONE ||
+				     tx_status == RTW89_TX_RETRY_LIMIT);
+
+	if (*locked != tx_ring) {
+		if (*locked)
+			rtw89_pci_tx_ring_unlock(*locked);
+		rtw89_pci_tx_ring_lock(tx_ring);
+		*locked = tx_ring;
+	}
 
-	rtw89_pci_release_txwd_skb(rtwdev, tx_ring, txwd, seq, tx_status);
+	rtw89_pci_release_txwd_skb(rtwdev, tx_ring, txwd, seq, tx_status, done);
 }
 
 static void rtw89_pci_release_pending_txwd_skb(struct rtw89_dev *rtwdev,
-					       struct rtw89_pci_tx_ring *tx_ring)
+					       struct rtw89_pci_tx_ring *tx_ring,
+					       struct sk_buff_head *done)
 {
 	struct rtw89_pci_tx_wd_ring *wd_ring = &tx_ring->wd_ring;
 	struct rtw89_pci_tx_wd *txwd;
@@ -596,18 +951,20 @@ static void rtw89_pci_release_pending_txwd_skb(struct rtw89_dev *rtwdev,
 	for (i = 0; i < wd_ring->page_num; i++) {
 		txwd = &wd_ring->pages[i];
 
-		if (!list_empty(&txwd->list))
+		if (txwd->queued)
 			continue;
 
-		rtw89_pci_release_txwd_skb(rtwdev, tx_ring, txwd, i, RTW89_TX_MACID_DROP);
+		rtw89_pci_release_txwd_skb(rtwdev, tx_ring, txwd, i,
+					   RTW89_TX_MACID_DROP, done);
 	}
 }
 
 static u32 rtw89_pci_release_tx_skbs(struct rtw89_dev *rtwdev,
 				     struct rtw89_pci_rx_ring *rx_ring,
-				     u32 max_cnt)
+				     u32 max_cnt, struct sk_buff_head *done)
 {
 	struct rtw89_pci_dma_ring *bd_ring = &rx_ring->bd_ring;
+	struct rtw89_pci_tx_ring *locked = NULL;
 	struct rtw89_pci_rx_info *rx_info;
 	struct rtw89_pci_rpp_fmt *rpp;
 	struct rtw89_rx_desc_info desc_info = {};
@@ -641,8 +998,12 @@ static u32 rtw89_pci_release_tx_skbs(struct rtw89_dev *rtwdev,
 	offset = desc_info.offset + desc_info.rxd_len;
 	for (; offset + rpp_size <= rx_info->len; offset += rpp_size) {
 		rpp = (struct rtw89_pci_rpp_fmt *)(skb->data + offset);
-		rtw89_pci_release_rpp(rtwdev, rpp);
+		if (offset + 2 * rpp_size <= rx_info->len)
+			rtw89_pci_prefetch_rpp(rtwdev, rpp + 1);
+		rtw89_pci_release_rpp(rtwdev, rpp, &locked, done);
 	}
+	if (locked)
+		rtw89_pci_tx_ring_unlock(locked);
 
 	rtw89_pci_sync_skb_for_device(rtwdev, skb);
 	rtw89_pci_rxbd_increase(rx_ring, 1);
@@ -657,13 +1018,13 @@ err_sync_device:
 
 static void rtw89_pci_release_tx(struct rtw89_dev *rtwdev,
 				 struct rtw89_pci_rx_ring *rx_ring,
-				 u32 cnt)
+				 u32 cnt, struct sk_buff_head *done)
 {
 	struct rtw89_pci_dma_ring *bd_ring = &rx_ring->bd_ring;
 	u32 release_cnt;
 
 	while (cnt) {
-		release_cnt = rtw89_pci_release_tx_skbs(rtwdev, rx_ring, cnt);
+		release_cnt = rtw89_pci_release_tx_skbs(rtwdev, rx_ring, cnt, done);
 		if (!release_cnt) {
 			rtw89_err(rtwdev, "failed to release TX skbs\n");
 
@@ -682,25 +1043,33 @@ static int rtw89_pci_poll_rpq_dma(struct rtw89_dev *rtwdev,
 				  struct rtw89_pci *rtwpci, int budget)
 {
 	struct rtw89_pci_rx_ring *rx_ring;
+	struct sk_buff_head done;
 	u32 cnt;
 	int work_done;
 
 	rx_ring = &rtwpci->rx_rings[RTW89_RXCH_RPQ];
+	__skb_queue_head_init(&done);
 
-	spin_lock_bh(&rtwpci->trx_lock);
+	rtw89_pci_rpq_lock(rtwpci);
 
 	cnt = rtw89_pci_rxbd_recalc(rtwdev, rx_ring);
 	if (cnt == 0)
 		goto out_unlock;
 
-	rtw89_pci_release_tx(rtwdev, rx_ring, cnt);
+	rx_ring->bd_hwm = max(rx_ring->bd_hwm, cnt);
+
+	rtw89_pci_release_tx(rtwdev, rx_ring, cnt, &done);
 
 out_unlock:
-	spin_unlock_bh(&rtwpci->trx_lock);
+	rtw89_pci_rpq_unlock(rtwpci);
+
+	rtw89_pci_tx_status_report(rtwdev, &done);
+
+	if (cnt)
+		rtw89_core_txq_tx_done(rtwdev);
 
 	/* always release all RPQ */
 	work_done = min_t(int, cnt, budget);
-	rtwdev->napi_budget_countdown -= work_done;
 
 	return work_done;
 }
@@ -791,8 +1160,8 @@ EXPORT_SYMBOL(rtw89_pci_recognize_intrs_v2);
 void rtw89_pci_enable_intr(struct rtw89_dev *rtwdev, struct rtw89_pci *rtwpci)
 {
 	rtw89_write32(rtwdev, R_AX_HIMR0, rtwpci->halt_c2h_intrs);
-	rtw89_write32(rtwdev, R_AX_PCIE_HIMR00, rtwpci->intrs[0]);
-	rtw89_write32(rtwdev, R_AX_PCIE_HIMR10, rtwpci->intrs[1]);
+	rtw89_write32(rtwdev, R_AX_PCIE_HIMR00, rtw89_pci_get_intrs(rtwpci, 0));
+	rtw89_write32(rtwdev, R_AX_PCIE_HIMR10, rtw89_pci_get_intrs(rtwpci, 1));
 }
 EXPORT_SYMBOL(rtw89_pci_enable_intr);
 
@@ -808,8 +1177,8 @@ void rtw89_pci_enable_intr_v1(struct rtw89_dev *rtwdev, struct rtw89_pci *rtwpci
 {
 	rtw89_write32(rtwdev, R_AX_PCIE_HIMR00_V1, rtwpci->ind_intrs);
 	rtw89_write32(rtwdev, R_AX_HIMR0, rtwpci->halt_c2h_intrs);
-	rtw89_write32(rtwdev, R_AX_HAXI_HIMR00, rtwpci->intrs[0]);
-	rtw89_write32(rtwdev, R_AX_HIMR1, rtwpci->intrs[1]);
+	rtw89_write32(rtwdev, R_AX_HAXI_HIMR00, rtw89_pci_get_intrs(rtwpci, 0));
+	rtw89_write32(rtwdev, R_AX_HIMR1, rtw89_pci_get_intrs(rtwpci, 1));
 }
 EXPORT_SYMBOL(rtw89_pci_enable_intr_v1);
 
@@ -822,8 +1191,8 @@ EXPORT_SYMBOL(rtw89_pci_disable_intr_v1);
 void rtw89_pci_enable_intr_v2(struct rtw89_dev *rtwdev, struct rtw89_pci *rtwpci)
 {
 	rtw89_write32(rtwdev, R_BE_HIMR0, rtwpci->halt_c2h_intrs);
-	rtw89_write32(rtwdev, R_BE_HAXI_HIMR00, rtwpci->intrs[0]);
-	rtw89_write32(rtwdev, R_BE_PCIE_DMA_IMR_0_V1, rtwpci->intrs[1]);
+	rtw89_write32(rtwdev, R_BE_HAXI_HIMR00, rtw89_pci_get_intrs(rtwpci, 0));
+	rtw89_write32(rtwdev, R_BE_PCIE_DMA_IMR_0_V1, rtw89_pci_get_intrs(rtwpci, 1));
 	rtw89_write32(rtwdev, R_BE_PCIE_HIMR0, rtwpci->ind_intrs);
 }
 EXPORT_SYMBOL(rtw89_pci_enable_intr_v2);
@@ -859,16 +1228,66 @@ static void rtw89_pci_ops_recovery_complete(struct rtw89_dev *rtwdev)
 	spin_unlock_irqrestore(&rtwpci->irq_lock, flags);
 }
 
-static void rtw89_pci_low_power_interrupt_handler(struct rtw89_dev *rtwdev)
+static bool rtw89_pci_isrs_hit(const struct rtw89_pci_isrs *isrs,
+			       const u32 *intrs)
 {
-	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
-	int budget = NAPI_POLL_WEIGHT;
+	return (isrs->isrs[0] & intrs[0]) || (isrs->isrs[1] & intrs[1]);
+}
 
-	/* To prevent RXQ get stuck due to run out of budget. */
-	rtwdev->napi_budget_countdown = budget;
+static void rtw89_pci_schedule_napi(struct rtw89_dev *rtwdev,
+				    struct rtw89_pci *rtwpci,
+				    const struct rtw89_pci_isrs *isrs)
+{
+	const struct rtw89_pci_info *info = rtwdev->pci_info;
+	const struct rtw89_pci_gen_def *gen_def = info->gen_def;
+	unsigned long flags;
+	bool rpq, rxq;
+
+	rpq = rtw89_pci_isrs_hit(isrs, rtwpci->rpq_intrs);
+	/* RDU is recovered by draining RXQ */
+	rxq = rtw89_pci_isrs_hit(isrs, rtwpci->rxq_intrs) ||
+	      rtw89_pci_isrs_hit(isrs, rtwpci->lp_intrs) ||
+	      (isrs->isrs[0] & gen_def->isr_rdu);
+
+	if (!rpq && !rxq)
+		return;
 
-	rtw89_pci_poll_rpq_dma(rtwdev, rtwpci, budget);
-	rtw89_pci_poll_rxq_dma(rtwdev, rtwpci, budget);
+	/* Hold off interrupts of the ring until its NAPI completes, so the
+	 * other ring can keep interrupting meanwhile.
+	 */
+	spin_lock_irqsave(&rtwpci->irq_lock, flags);
+	if (rpq) {
+		rtwpci->napi_masked_intrs[0] |= rtwpci->rpq_intrs[0];
+		rtwpci->napi_masked_intrs[1] |= rtwpci->rpq_intrs[1];
+	}
+	if (rxq) {
+		rtwpci->napi_masked_intrs[0] |= rtwpci->rxq_intrs[0] |
+						rtwpci->lp_intrs[0];
+		rtwpci->napi_masked_intrs[1] |= rtwpci->rxq_intrs[1] |
+						rtwpci->lp_intrs[1];
+	}
+	spin_unlock_irqrestore(&rtwpci->irq_lock, flags);
+
+	local_bh_disable();
+	if (rpq)
+		napi_schedule(&rtwdev->napi_tx);
+	if (rxq)
+		napi_schedule(&rtwdev->napi);
+	local_bh_enable();
+}
+
+static void rtw89_pci_napi_unmask_intrs(struct rtw89_dev *rtwdev,
+					struct rtw89_pci *rtwpci,
+					const u32 *intrs)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&rtwpci->irq_lock, flags);
+	rtwpci->napi_masked_intrs[0] &= ~intrs[0];
+	rtwpci->napi_masked_intrs[1] &= ~intrs[1];
+	if (likely(rtwpci->running))
+		rtw89_chip_enable_intr(rtwdev, rtwpci);
+	spin_unlock_irqrestore(&rtwpci->irq_lock, flags);
 }
 
 static irqreturn_t rtw89_pci_interrupt_threadfn(int irq, void *dev)
@@ -896,18 +1315,8 @@ static irqreturn_t rtw89_pci_interrupt_threadfn(int irq, void *dev)
 	if (unlikely(rtwpci->under_recovery))
 		goto enable_intr;
 
-	if (unlikely(rtwpci->low_power)) {
-		rtw89_pci_low_power_interrupt_handler(rtwdev);
-		goto enable_intr;
-	}
-
-	if (likely(rtwpci->running)) {
-		local_bh_disable();
-		napi_schedule(&rtwdev->napi);
-		local_bh_enable();
-	}
-
-	return IRQ_HANDLED;
+	if (likely(rtwpci->running))
+		rtw89_pci_schedule_napi(rtwdev, rtwpci, &isrs);
 
 enable_intr:
 	spin_lock_irqsave(&rtwpci->irq_lock, flags);
@@ -1095,10 +1504,10 @@ u32 __rtw89_pci_check_and_reclaim_tx_fwcmd_resource(struct rtw89_dev *rtwdev)
 	struct rtw89_pci_tx_ring *tx_ring = &rtwpci->tx_rings[RTW89_TXCH_CH12];
 	u32 cnt;
 
-	spin_lock_bh(&rtwpci->trx_lock);
+	rtw89_pci_tx_ring_lock(tx_ring);
 	rtw89_pci_reclaim_tx_fwcmd(rtwdev, rtwpci);
 	cnt = rtw89_pci_get_avail_txbd_num(tx_ring);
-	spin_unlock_bh(&rtwpci->trx_lock);
+	rtw89_pci_tx_ring_unlock(tx_ring);
 
 	return cnt;
 }
@@ -1112,11 +1521,11 @@ u32 __rtw89_pci_check_and_reclaim_tx_resource_noio(struct rtw89_dev *rtwdev,
 	struct rtw89_pci_tx_wd_ring *wd_ring = &tx_ring->wd_ring;
 	u32 cnt;
 
-	spin_lock_bh(&rtwpci->trx_lock);
+	rtw89_pci_tx_ring_lock(tx_ring);
 	cnt = rtw89_pci_get_avail_txbd_num(tx_ring);
 	if (txch != RTW89_TXCH_CH12)
 		cnt = min(cnt, wd_ring->curr_num);
-	spin_unlock_bh(&rtwpci->trx_lock);
+	rtw89_pci_tx_ring_unlock(tx_ring);
 
 	return cnt;
 }
@@ -1131,19 +1540,31 @@ static u32 __rtw89_pci_check_and_reclaim_tx_resource(struct rtw89_dev *rtwdev,
 	u32 bd_cnt, wd_cnt, min_cnt = 0;
 	struct rtw89_pci_rx_ring *rx_ring;
 	enum rtw89_debug_mask debug_mask;
+	struct sk_buff_head done;
 	u32 cnt;
 
 	rx_ring = &rtwpci->rx_rings[RTW89_RXCH_RPQ];
 
-	spin_lock_bh(&rtwpci->trx_lock);
+	rtw89_pci_tx_ring_lock(tx_ring);
 	bd_cnt = rtw89_pci_get_avail_txbd_num(tx_ring);
 	wd_cnt = wd_ring->curr_num;
 
 	if (wd_cnt == 0 || bd_cnt == 0) {
+		/* RPQ releases resources under tx_ring->lock by itself */
+		rtw89_pci_tx_ring_unlock(tx_ring);
+
+		__skb_queue_head_init(&done);
+
+		rtw89_pci_rpq_lock(rtwpci);
 		cnt = rtw89_pci_rxbd_recalc(rtwdev, rx_ring);
 		if (cnt)
-			rtw89_pci_release_tx(rtwdev, rx_ring, cnt);
-		else if (wd_cnt == 0)
+			rtw89_pci_release_tx(rtwdev, rx_ring, cnt, &done);
+		rtw89_pci_rpq_unlock(rtwpci);
+
+		rtw89_pci_tx_status_report(rtwdev, &done);
+
+		rtw89_pci_tx_ring_lock(tx_ring);
+		if (!cnt && wd_cnt == 0)
 			goto out_unlock;
 
 		bd_cnt = rtw89_pci_get_avail_txbd_num(tx_ring);
@@ -1155,6 +1576,8 @@ static u32 __rtw89_pci_check_and_reclaim_tx_resource(struct rtw89_dev *rtwdev,
 	wd_cnt = wd_ring->curr_num;
 	min_cnt = min(bd_cnt, wd_cnt);
 	if (min_cnt == 0) {
+		tx_ring->tx_full_cnt++;
+
 		/* This message can be frequently shown in low power mode or
 		 * high traffic with small FIFO chips, and we have recognized it as normal
 		 * behavior, so print with mask RTW89_DBG_TXRX in these situations.
@@ -1170,7 +1593,7 @@ static u32 __rtw89_pci_check_and_reclaim_tx_resource(struct rtw89_dev *rtwdev,
 	}
 
 out_unlock:
-	spin_unlock_bh(&rtwpci->trx_lock);
+	rtw89_pci_tx_ring_unlock(tx_ring);
 
 	return min_cnt;
 }
@@ -1187,19 +1610,47 @@ static u32 rtw89_pci_check_and_reclaim_tx_resource(struct rtw89_dev *rtwdev,
 	return __rtw89_pci_check_and_reclaim_tx_resource(rtwdev, txch);
 }
 
+/* Frames written since the last doorbell are at the tail of the busy FIFO,
+ * because the device doesn't fetch a BD before its doorbell.
+ */
+static void rtw89_pci_tx_lat_stamp_kick(struct rtw89_pci_tx_ring *tx_ring)
+{
+	struct rtw89_pci_tx_wd_ring *wd_ring = &tx_ring->wd_ring;
+	u32 n = min(tx_ring->unkicked, wd_ring->busy_num);
+	struct rtw89_pci_tx_wd *txwd;
+	ktime_t now = ktime_get();
+	u32 idx;
+
+	idx = wd_ring->busy_head + wd_ring->busy_num;
+	if (idx >= wd_ring->page_num)
+		idx -= wd_ring->page_num;
+
+	while (n--) {
+		idx = (idx ? idx : wd_ring->page_num) - 1;
+		txwd = &wd_ring->pages[wd_ring->busy_fifo[idx]];
+		if (txwd->enqueue_ts && !txwd->kick_ts)
+			txwd->kick_ts = now;
+	}
+
+	tx_ring->unkicked = 0;
+}
+
 static void __rtw89_pci_tx_kick_off(struct rtw89_dev *rtwdev, struct rtw89_pci_tx_ring *tx_ring)
 {
-	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
 	struct rtw89_pci_dma_ring *bd_ring = &tx_ring->bd_ring;
 	u32 host_idx, addr;
 
-	spin_lock_bh(&rtwpci->trx_lock);
+	rtw89_pci_tx_ring_lock(tx_ring);
 
 	addr = bd_ring->addr.idx;
 	host_idx = bd_ring->wp;
 	rtw89_write16(rtwdev, addr, host_idx);
+	tx_ring->kick_cnt++;
+	trace_rtw89_pci_tx_kick_off(rtwdev, tx_ring->txch, host_idx);
+	if (unlikely(tx_ring->unkicked))
+		rtw89_pci_tx_lat_stamp_kick(tx_ring);
 
-	spin_unlock_bh(&rtwpci->trx_lock);
+	rtw89_pci_tx_ring_unlock(tx_ring);
 }
 
 static void rtw89_pci_tx_bd_ring_update(struct rtw89_dev *rtwdev, struct rtw89_pci_tx_ring *tx_ring,
@@ -1213,6 +1664,8 @@ static void rtw89_pci_tx_bd_ring_update(struct rtw89_dev *rtwdev, struct rtw89_p
 	host_idx = host_idx < len ? host_idx : host_idx - len;
 
 	bd_ring->wp = host_idx;
+	tx_ring->bd_hwm = max(tx_ring->bd_hwm,
+			      len - 1 - rtw89_pci_get_avail_txbd_num(tx_ring));
 }
 
 static void rtw89_pci_ops_tx_kick_off(struct rtw89_dev *rtwdev, u8 txch)
@@ -1243,54 +1696,107 @@ static void rtw89_pci_tx_kick_off_pending(struct rtw89_dev *rtwdev)
 	}
 }
 
-static void __pci_flush_txch(struct rtw89_dev *rtwdev, u8 txch, bool drop)
+static bool rtw89_pci_txch_flushed(struct rtw89_dev *rtwdev, u8 txch)
 {
 	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
-	struct rtw89_pci_tx_ring *tx_ring = &rtwpci->tx_rings[txch];
-	struct rtw89_pci_dma_ring *bd_ring = &tx_ring->bd_ring;
-	u32 cur_idx, cur_rp;
-	u8 i;
+	struct rtw89_pci_tx_wd_ring *wd_ring = &rtwpci->tx_rings[txch].wd_ring;
 
-	/* Because the time taked by the I/O is a bit dynamic, it's hard to
-	 * define a reasonable fixed total timeout to use read_poll_timeout*
-	 * helper. Instead, we can ensure a reasonable polling times, so we
-	 * just use for loop with udelay here.
-	 */
-	for (i = 0; i < 60; i++) {
-		cur_idx = rtw89_read32(rtwdev, bd_ring->addr.idx);
-		cur_rp = FIELD_GET(TXBD_HW_IDX_MASK, cur_idx);
-		if (cur_rp == bd_ring->wp)
-			return;
+	/* a WD page is back only after its BD is fetched and RPP is received */
+	return READ_ONCE(wd_ring->curr_num) == wd_ring->page_num;
+}
 
-		udelay(1);
+static u32 rtw89_pci_pending_txchs(struct rtw89_dev *rtwdev, u32 txchs)
+{
+	u32 pending = 0;
+	u8 i;
+
+	for (i = 0; i < RTW89_TXCH_NUM; i++) {
+		if (txchs & BIT(i) && !rtw89_pci_txch_flushed(rtwdev, i))
+			pending |= BIT(i);
 	}
 
-	if (!drop)
-		rtw89_info(rtwdev, "timed out to flush pci txch: %d\n", txch);
+	return pending;
 }
 
-static void __rtw89_pci_ops_flush_txchs(struct rtw89_dev *rtwdev, u32 txchs,
-					bool drop)
+static u32 rtw89_pci_queues_to_txchs(struct rtw89_dev *rtwdev, u32 queues)
 {
 	const struct rtw89_pci_info *info = rtwdev->pci_info;
-	u8 i;
+	u32 txchs = 0;
+	u8 tid;
 
-	for (i = 0; i < RTW89_TXCH_NUM; i++) {
-		/* It may be unnecessary to flush FWCMD queue. */
-		if (i == RTW89_TXCH_CH12)
-			continue;
-		if (info->tx_dma_ch_mask & BIT(i))
+	for (tid = 0; tid < IEEE80211_NUM_TIDS / 2; tid++) {
+		if (!(queues & BIT(ieee80211_ac_from_tid(tid))))
 			continue;
 
-		if (txchs & BIT(i))
-			__pci_flush_txch(rtwdev, i, drop);
+		txchs |= BIT(rtw89_core_get_ch_dma(rtwdev,
+						   rtw89_core_get_qsel_band(rtwdev, tid,
+									    RTW89_MAC_0)));
+		txchs |= BIT(rtw89_core_get_ch_dma(rtwdev,
+						   rtw89_core_get_qsel_band(rtwdev, tid,
+									    RTW89_MAC_1)));
 	}
+
+	/* mac80211 puts management frames on VO */
+	if (queues & BIT(IEEE80211_AC_VO))
+		txchs |= BIT(RTW89_TXCH_CH8) | BIT(RTW89_TXCH_CH9) |
+			 BIT(RTW89_TXCH_CH10) | BIT(RTW89_TXCH_CH11);
+
+	/* It may be unnecessary to flush FWCMD queue. */
+	txchs &= ~BIT(RTW89_TXCH_CH12);
+
+	return txchs & ~info->tx_dma_ch_mask;
+}
+
+static void rtw89_pci_flush_stats_update(struct rtw89_pci_flush_stats *stats,
+					 s64 us, bool timeout)
+{
+	stats->cnt++;
+	stats->total_us += us;
+	stats->max_us = max_t(u64, stats->max_us, us);
+	if (timeout)
+		stats->timeout++;
 }
 
 static void rtw89_pci_ops_flush_queues(struct rtw89_dev *rtwdev, u32 queues,
-				       bool drop)
+				       enum rtw89_flush_mode mode)
 {
-	__rtw89_pci_ops_flush_txchs(rtwdev, BIT(RTW89_TXCH_NUM) - 1, drop);
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	struct rtw89_pci_flush_stats *stats = &rtwpci->flush_stats;
+	u32 txchs = rtw89_pci_queues_to_txchs(rtwdev, queues);
+	ktime_t start;
+	u32 pending;
+	int ret;
+
+	if (mode == RTW89_FLUSH_DROP) {
+		stats->drop++;
+		return;
+	}
+
+	/* kicks are held while paused, so those frames can't complete */
+	if (rtwdev->hci.paused) {
+		stats->paused++;
+		return;
+	}
+
+	start = ktime_get();
+	if (mode == RTW89_FLUSH_SHORT)
+		ret = read_poll_timeout(rtw89_pci_pending_txchs, pending, !pending,
+					10, RTW89_PCI_FLUSH_SHORT_TIMEOUT_US,
+					false, rtwdev, txchs);
+	else if (!wait_event_timeout(rtwpci->flush_wq,
+				     !rtw89_pci_pending_txchs(rtwdev, txchs),
+				     msecs_to_jiffies(RTW89_PCI_FLUSH_TIMEOUT_MS)))
+		ret = -ETIMEDOUT;
+	else
+		ret = 0;
+	rtw89_pci_flush_stats_update(stats, ktime_us_delta(ktime_get(), start),
+				     !!ret);
+
+	if (ret) {
+		pending = rtw89_pci_pending_txchs(rtwdev, txchs);
+		rtw89_info(rtwdev, "timed out to flush pci txchs: 0x%x\n",
+			   pending);
+	}
 }
 
 u32 rtw89_pci_fill_txaddr_info(struct rtw89_dev *rtwdev,
@@ -1310,41 +1816,181 @@ u32 rtw89_pci_fill_txaddr_info(struct rtw89_dev *rtwdev,
 }
 EXPORT_SYMBOL(rtw89_pci_fill_txaddr_info);
 
-u32 rtw89_pci_fill_txaddr_info_v1(struct rtw89_dev *rtwdev,
-				  void *txaddr_info_addr, u32 total_len,
-				  dma_addr_t dma, u8 *add_info_nr)
+u32 rtw89_pci_fill_txaddr_info_sg_v1(struct rtw89_dev *rtwdev,
+				     void *txaddr_info_addr,
+				     const struct rtw89_pci_tx_seg *segs,
+				     u8 nr_segs, u8 *add_info_nr)
 {
 	struct rtw89_pci_tx_addr_info_32_v1 *txaddr_info = txaddr_info_addr;
-	u32 remain = total_len;
+	u32 remain = 0;
+	dma_addr_t dma;
 	u32 len;
 	u16 length_option;
-	int n;
-
-	for (n = 0; n < RTW89_TXADDR_INFO_NR_V1 && remain; n++) {
-		len = remain >= TXADDR_INFO_LENTHG_V1_MAX ?
-		      TXADDR_INFO_LENTHG_V1_MAX : remain;
-		remain -= len;
+	bool last;
+	int n = 0;
+	u8 i;
 
-		length_option = FIELD_PREP(B_PCIADDR_LEN_V1_MASK, len) |
-				FIELD_PREP(B_PCIADDR_HIGH_SEL_V1_MASK, 0) |
-				FIELD_PREP(B_PCIADDR_LS_V1_MASK, remain == 0);
-		txaddr_info->length_opt = cpu_to_le16(length_option);
-		txaddr_info->dma_low_lsb = cpu_to_le16(FIELD_GET(GENMASK(15, 0), dma));
-		txaddr_info->dma_low_msb = cpu_to_le16(FIELD_GET(GENMASK(31, 16), dma));
+	for (i = 0; i < nr_segs; i++) {
+		dma = segs[i].dma;
+		remain = segs[i].len;
+
+		for (; n < RTW89_TXADDR_INFO_NR_V1 && remain; n++) {
+			len = remain >= TXADDR_INFO_LENTHG_V1_MAX ?
+			      TXADDR_INFO_LENTHG_V1_MAX : remain;
+			remain -= len;
+			last = remain == 0 && i == nr_segs - 1;
+
+			length_option = FIELD_PREP(B_PCIADDR_LEN_V1_MASK, len) |
+					FIELD_PREP(B_PCIADDR_HIGH_SEL_V1_MASK, 0) |
+					FIELD_PREP(B_PCIADDR_LS_V1_MASK, last);
+			txaddr_info->length_opt = cpu_to_le16(length_option);
+			txaddr_info->dma_low_lsb = cpu_to_le16(FIELD_GET(GENMASK(15, 0), dma));
+			txaddr_info->dma_low_msb = cpu_to_le16(FIELD_GET(GENMASK(31, 16), dma));
+
+			dma += len;
+			txaddr_info++;
+		}
 
-		dma += len;
-		txaddr_info++;
+		if (remain)
+			break;
 	}
 
-	WARN_ONCE(remain, "length overflow remain=%u total_len=%u",
-		  remain, total_len);
+	WARN_ONCE(remain, "length overflow remain=%u seg=%u/%u",
+		  remain, i, nr_segs);
 
 	*add_info_nr = n;
 
 	return n * sizeof(*txaddr_info);
 }
+EXPORT_SYMBOL(rtw89_pci_fill_txaddr_info_sg_v1);
+
+u32 rtw89_pci_fill_txaddr_info_v1(struct rtw89_dev *rtwdev,
+				  void *txaddr_info_addr, u32 total_len,
+				  dma_addr_t dma, u8 *add_info_nr)
+{
+	struct rtw89_pci_tx_seg seg = {.dma = dma, .len = total_len};
+
+	return rtw89_pci_fill_txaddr_info_sg_v1(rtwdev, txaddr_info_addr,
+						&seg, 1, add_info_nr);
+}
 EXPORT_SYMBOL(rtw89_pci_fill_txaddr_info_v1);
 
+static u32 rtw89_pci_tx_skb_addr_info_num(struct sk_buff *skb)
+{
+	struct skb_shared_info *shinfo = skb_shinfo(skb);
+	u32 num;
+	int i;
+
+	num = DIV_ROUND_UP(skb_headlen(skb), TXADDR_INFO_LENTHG_V1_MAX);
+	for (i = 0; i < shinfo->nr_frags; i++)
+		num += DIV_ROUND_UP(skb_frag_size(&shinfo->frags[i]),
+				    TXADDR_INFO_LENTHG_V1_MAX);
+
+	return num;
+}
+
+/* Only the v1 address info, which has LS bit per entry, can describe a
+ * frame in several buffers. The entries follow TXWD body, TXWD info and WP
+ * info in the same TXWD page, so the number of them depends on the chip.
+ */
+static u8 rtw89_pci_tx_addr_info_max_nr(const struct rtw89_chip_info *chip)
+{
+	u32 room = RTW89_PCI_TXWD_PAGE_SIZE - chip->txwd_body_size -
+		   chip->txwd_info_size - sizeof(struct rtw89_pci_tx_wp_info);
+
+	/* the largest TXWD layout must leave room for a frame in two buffers */
+	BUILD_BUG_ON(sizeof(struct rtw89_txwd_body_v2) +
+		     sizeof(struct rtw89_txwd_info_v2) +
+		     sizeof(struct rtw89_pci_tx_wp_info) +
+		     2 * sizeof(struct rtw89_pci_tx_addr_info_32_v1) >
+		     RTW89_PCI_TXWD_PAGE_SIZE);
+
+	return min_t(u32, room / sizeof(struct rtw89_pci_tx_addr_info_32_v1),
+		     RTW89_TXADDR_INFO_NR_V1);
+}
+
+static bool rtw89_pci_tx_sg_fits(struct rtw89_dev *rtwdev, struct sk_buff *skb)
+{
+	struct sk_buff *iter;
+	u32 num;
+
+	num = rtw89_pci_tx_skb_addr_info_num(skb);
+	skb_walk_frags(skb, iter)
+		num += rtw89_pci_tx_skb_addr_info_num(iter);
+
+	return num <= rtwdev->hci.tx_max_frags;
+}
+
+static int rtw89_pci_tx_map_skb_segs(struct device *dev, struct sk_buff *skb,
+				     struct rtw89_pci_tx_seg *segs, u8 *nr_segs)
+{
+	struct skb_shared_info *shinfo = skb_shinfo(skb);
+	struct rtw89_pci_tx_seg *seg;
+	skb_frag_t *frag;
+	int i;
+
+	if (skb_headlen(skb)) {
+		seg = &segs[(*nr_segs)++];
+		seg->len = skb_headlen(skb);
+		seg->page = false;
+		seg->dma = dma_map_single(dev, skb->data, seg->len, DMA_TO_DEVICE);
+		if (dma_mapping_error(dev, seg->dma)) {
+			(*nr_segs)--;
+			return -EBUSY;
+		}
+	}
+
+	for (i = 0; i < shinfo->nr_frags; i++) {
+		frag = &shinfo->frags[i];
+		if (!skb_frag_size(frag))
+			continue;
+
+		seg = &segs[(*nr_segs)++];
+		seg->len = skb_frag_size(frag);
+		seg->page = true;
+		seg->dma = skb_frag_dma_map(dev, frag, 0, seg->len, DMA_TO_DEVICE);
+		if (dma_mapping_error(dev, seg->dma)) {
+			(*nr_segs)--;
+			return -EBUSY;
+		}
+	}
+
+	return 0;
+}
+
+static int rtw89_pci_txwd_map_sg(struct rtw89_dev *rtwdev,
+				 struct rtw89_pci_tx_wd *txwd,
+				 struct sk_buff *skb)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	struct device *dev = &rtwpci->pdev->dev;
+	struct rtw89_pci_tx_seg *segs = txwd->segs;
+	struct sk_buff *iter;
+	u8 nr_segs = 0;
+	int ret;
+
+	/* each buffer takes one address info at least, so segs[] can't
+	 * overflow once rtw89_pci_tx_sg_fits() passes
+	 */
+	ret = rtw89_pci_tx_map_skb_segs(dev, skb, segs, &nr_segs);
+	if (ret)
+		goto err_unmap;
+
+	skb_walk_frags(skb, iter) {
+		ret = rtw89_pci_tx_map_skb_segs(dev, iter, segs, &nr_segs);
+		if (ret)
+			goto err_unmap;
+	}
+
+	txwd->nr_segs = nr_segs;
+
+	return 0;
+
+err_unmap:
+	rtw89_pci_tx_unmap_segs(dev, segs, nr_segs);
+	return ret;
+}
+
 static int rtw89_pci_txwd_submit(struct rtw89_dev *rtwdev,
 				 struct rtw89_pci_tx_ring *tx_ring,
 				 struct rtw89_pci_tx_wd *txwd,
@@ -1359,18 +2005,33 @@ static int rtw89_pci_txwd_submit(struct rtw89_dev *rtwdev,
 	struct sk_buff *skb = tx_req->skb;
 	struct rtw89_pci_tx_data *tx_data = RTW89_PCI_TX_SKB_CB(skb);
 	struct rtw89_tx_skb_data *skb_data = RTW89_TX_SKB_CB(skb);
+	const struct rtw89_pci_info *info = rtwdev->pci_info;
 	bool en_wd_info = desc_info->en_wd_info;
 	u32 txwd_len;
 	u32 txwp_len;
 	u32 txaddr_info_len;
-	dma_addr_t dma;
+	dma_addr_t dma = 0;
+	bool sg = false;
 	int ret;
 
-	dma = dma_map_single(&pdev->dev, skb->data, skb->len, DMA_TO_DEVICE);
-	if (dma_mapping_error(&pdev->dev, dma)) {
-		rtw89_err(rtwdev, "failed to map skb dma data\n");
-		ret = -EBUSY;
-		goto err;
+	if (skb_is_nonlinear(skb)) {
+		if (info->fill_txaddr_info_sg && rtw89_pci_tx_sg_fits(rtwdev, skb))
+			sg = !rtw89_pci_txwd_map_sg(rtwdev, txwd, skb);
+
+		if (!sg && skb_linearize(skb)) {
+			rtw89_err(rtwdev, "failed to linearize skb\n");
+			ret = -ENOMEM;
+			goto err;
+		}
+	}
+
+	if (!sg) {
+		dma = dma_map_single(&pdev->dev, skb->data, skb->len, DMA_TO_DEVICE);
+		if (dma_mapping_error(&pdev->dev, dma)) {
+			rtw89_err(rtwdev, "failed to map skb dma data\n");
+			ret = -EBUSY;
+			goto err;
+		}
 	}
 
 	tx_data->dma = dma;
@@ -1388,9 +2049,17 @@ static int rtw89_pci_txwd_submit(struct rtw89_dev *rtwdev,
 
 	tx_ring->tx_cnt++;
 	txaddr_info_addr = txwd->vaddr + txwd_len + txwp_len;
-	txaddr_info_len =
-		rtw89_chip_fill_txaddr_info(rtwdev, txaddr_info_addr, skb->len,
-					    dma, &desc_info->addr_info_nr);
+	if (sg) {
+		tx_ring->tx_sg_cnt++;
+		txaddr_info_len =
+			info->fill_txaddr_info_sg(rtwdev, txaddr_info_addr,
+						  txwd->segs, txwd->nr_segs,
+						  &desc_info->addr_info_nr);
+	} else {
+		txaddr_info_len =
+			rtw89_chip_fill_txaddr_info(rtwdev, txaddr_info_addr, skb->len,
+						    dma, &desc_info->addr_info_nr);
+	}
 
 	txwd->len = txwd_len + txwp_len + txaddr_info_len;
 
@@ -1468,7 +2137,22 @@ static int rtw89_pci_txbd_submit(struct rtw89_dev *rtwdev,
 		goto err_enqueue_wd;
 	}
 
-	list_add_tail(&txwd->list, &tx_ring->busy_pages);
+	rtw89_pci_push_busy_txwd(&tx_ring->wd_ring, txwd);
+
+	txwd->mac_id = tx_req->desc_info.mac_id;
+	if (tx_req->sta && tx_req->tx_type == RTW89_CORE_TX_TYPE_DATA) {
+		txwd->tid = tx_req->skb->priority & IEEE80211_QOS_CTL_TID_MASK;
+		txwd->airtime_len = tx_req->desc_info.pkt_size;
+	} else {
+		txwd->airtime_len = 0;
+	}
+
+	txwd->enqueue_ts = tx_req->enqueue_ts;
+	txwd->kick_ts = 0;
+	if (unlikely(txwd->enqueue_ts)) {
+		txwd->ac = skb_get_queue_mapping(tx_req->skb);
+		tx_ring->unkicked++;
+	}
 
 	txbd->option = cpu_to_le16(RTW89_PCI_TXBD_OPTION_LS);
 	txbd->length = cpu_to_le16(txwd->len);
@@ -1503,7 +2187,7 @@ static int rtw89_pci_tx_write(struct rtw89_dev *rtwdev, struct rtw89_core_tx_req
 	}
 
 	tx_ring = &rtwpci->tx_rings[txch];
-	spin_lock_bh(&rtwpci->trx_lock);
+	rtw89_pci_tx_ring_lock(tx_ring);
 
 	n_avail_txbd = rtw89_pci_get_avail_txbd_num(tx_ring);
 	if (n_avail_txbd == 0) {
@@ -1519,11 +2203,11 @@ static int rtw89_pci_tx_write(struct rtw89_dev *rtwdev, struct rtw89_core_tx_req
 		goto err_unlock;
 	}
 
-	spin_unlock_bh(&rtwpci->trx_lock);
+	rtw89_pci_tx_ring_unlock(tx_ring);
 	return 0;
 
 err_unlock:
-	spin_unlock_bh(&rtwpci->trx_lock);
+	rtw89_pci_tx_ring_unlock(tx_ring);
 	return ret;
 }
 
@@ -1569,6 +2253,79 @@ const struct rtw89_pci_bd_ram rtw89_bd_ram_table_single[RTW89_TXCH_NUM] = {
 };
 EXPORT_SYMBOL(rtw89_bd_ram_table_single);
 
+/* Share BD-RAM of the chip, whose size is the sum of max_num of its
+ * bd_ram_table, among TX channels in proportion to their max_num scaled by
+ * configured number of BDs. With default ring sizes, this is the table.
+ */
+static void rtw89_pci_calc_bd_ram(struct rtw89_dev *rtwdev)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	const struct rtw89_pci_info *info = rtwdev->pci_info;
+	const struct rtw89_pci_bd_ram *bd_ram_table = *info->bd_ram_table;
+	struct rtw89_pci_ring_cfg *cfg = &rtwpci->ring_cfg;
+	struct rtw89_pci_bd_ram *bd_ram = rtwpci->bd_ram;
+	u32 weight[RTW89_TXCH_NUM] = {};
+	u32 total = 0, used = 0, sum = 0;
+	u32 num, start, slack, i, pick;
+
+	memset(bd_ram, 0, sizeof(rtwpci->bd_ram));
+
+	if (!bd_ram_table)
+		return;
+
+	for (i = 0; i < RTW89_TXCH_NUM; i++) {
+		if (!bd_ram_table[i].max_num)
+			continue;
+
+		total += bd_ram_table[i].max_num;
+		if (info->tx_dma_ch_mask & BIT(i))
+			continue;
+
+		weight[i] = bd_ram_table[i].max_num * cfg->txbd_num[i];
+		sum += weight[i];
+	}
+
+	if (!sum)
+		return;
+
+	for (i = 0; i < RTW89_TXCH_NUM; i++) {
+		if (!weight[i])
+			continue;
+
+		num = div_u64((u64)total * weight[i], sum);
+		num = max_t(u32, num, bd_ram_table[i].min_num);
+		bd_ram[i].max_num = num;
+		bd_ram[i].min_num = bd_ram_table[i].min_num;
+		used += num;
+	}
+
+	/* raising small channels to their minimum can overcommit */
+	while (used > total) {
+		pick = RTW89_TXCH_NUM;
+		slack = 0;
+		for (i = 0; i < RTW89_TXCH_NUM; i++) {
+			if (bd_ram[i].max_num - bd_ram[i].min_num > slack) {
+				slack = bd_ram[i].max_num - bd_ram[i].min_num;
+				pick = i;
+			}
+		}
+		if (pick == RTW89_TXCH_NUM)
+			break;
+
+		bd_ram[pick].max_num--;
+		used--;
+	}
+
+	start = 0;
+	for (i = 0; i < RTW89_TXCH_NUM; i++) {
+		if (!weight[i])
+			continue;
+
+		bd_ram[i].start_idx = start;
+		start += bd_ram[i].max_num;
+	}
+}
+
 static void rtw89_pci_reset_trx_rings(struct rtw89_dev *rtwdev)
 {
 	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
@@ -1591,7 +2348,7 @@ static void rtw89_pci_reset_trx_rings(struct rtw89_dev *rtwdev)
 
 		tx_ring = &rtwpci->tx_rings[i];
 		bd_ring = &tx_ring->bd_ring;
-		bd_ram = bd_ram_table ? &bd_ram_table[i] : NULL;
+		bd_ram = bd_ram_table ? &rtwpci->bd_ram[i] : NULL;
 		addr_num = bd_ring->addr.num;
 		addr_bdram = bd_ring->addr.bdram;
 		addr_desa_l = bd_ring->addr.desa_l;
@@ -1633,32 +2390,45 @@ static void rtw89_pci_reset_trx_rings(struct rtw89_dev *rtwdev)
 }
 
 static void rtw89_pci_release_tx_ring(struct rtw89_dev *rtwdev,
-				      struct rtw89_pci_tx_ring *tx_ring)
+				      struct rtw89_pci_tx_ring *tx_ring,
+				      struct sk_buff_head *done)
 {
 	rtw89_pci_release_busy_txwd(rtwdev, tx_ring);
-	rtw89_pci_release_pending_txwd_skb(rtwdev, tx_ring);
+	rtw89_pci_release_pending_txwd_skb(rtwdev, tx_ring, done);
 }
 
-void rtw89_pci_ops_reset(struct rtw89_dev *rtwdev)
+static void rtw89_pci_release_tx_rings(struct rtw89_dev *rtwdev)
 {
 	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
 	const struct rtw89_pci_info *info = rtwdev->pci_info;
+	struct rtw89_pci_tx_ring *tx_ring;
+	struct sk_buff_head done;
 	int txch;
 
-	rtw89_pci_reset_trx_rings(rtwdev);
+	__skb_queue_head_init(&done);
 
-	spin_lock_bh(&rtwpci->trx_lock);
 	for (txch = 0; txch < RTW89_TXCH_NUM; txch++) {
 		if (info->tx_dma_ch_mask & BIT(txch))
 			continue;
-		if (txch == RTW89_TXCH_CH12) {
+
+		tx_ring = &rtwpci->tx_rings[txch];
+		rtw89_pci_tx_ring_lock(tx_ring);
+		if (txch == RTW89_TXCH_CH12)
 			rtw89_pci_release_fwcmd(rtwdev, rtwpci,
 						skb_queue_len(&rtwpci->h2c_queue), true);
-			continue;
-		}
-		rtw89_pci_release_tx_ring(rtwdev, &rtwpci->tx_rings[txch]);
+		else
+			rtw89_pci_release_tx_ring(rtwdev, tx_ring, &done);
+		rtw89_pci_tx_ring_unlock(tx_ring);
 	}
-	spin_unlock_bh(&rtwpci->trx_lock);
+
+	/* mac80211 can push frames again from TX status */
+	rtw89_pci_tx_status_report(rtwdev, &done);
+}
+
+void rtw89_pci_ops_reset(struct rtw89_dev *rtwdev)
+{
+	rtw89_pci_reset_trx_rings(rtwdev);
+	rtw89_pci_release_tx_rings(rtwdev);
 }
 
 static void rtw89_pci_enable_intr_lock(struct rtw89_dev *rtwdev)
@@ -1668,23 +2438,222 @@ static void rtw89_pci_enable_intr_lock(struct rtw89_dev *rtwdev)
 
 	spin_lock_irqsave(&rtwpci->irq_lock, flags);
 	rtwpci->running = true;
+	rtwpci->napi_masked_intrs[0] = 0;
+	rtwpci->napi_masked_intrs[1] = 0;
 	rtw89_chip_enable_intr(rtwdev, rtwpci);
 	spin_unlock_irqrestore(&rtwpci->irq_lock, flags);
 }
 
-static void rtw89_pci_disable_intr_lock(struct rtw89_dev *rtwdev)
+static void rtw89_pci_disable_intr_lock(struct rtw89_dev *rtwdev)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	unsigned long flags;
+
+	spin_lock_irqsave(&rtwpci->irq_lock, flags);
+	rtwpci->running = false;
+	rtw89_chip_disable_intr(rtwdev, rtwpci);
+	spin_unlock_irqrestore(&rtwpci->irq_lock, flags);
+}
+
+static const struct rtw89_pci_rx_mit_prof
+rtw89_pci_rx_mit_profs_ax[RTW89_PCI_RX_DIM_NUM_PROFS] = {
+	{0, 0},
+	{4, 64},
+	{16, 256},
+	{64, 1024},
+	{RTW89_PCI_RX_MIT_CNT_HALF_RING, 2048},
+};
+
+static void rtw89_pci_rx_mit_set_ax(struct rtw89_dev *rtwdev,
+				    const struct rtw89_pci_rx_mit_prof *prof)
+{
+	const struct rtw89_pci_info *info = rtwdev->pci_info;
+	u32 val = 0;
+
+	if (prof->cnt)
+		val = B_AX_RXMIT_RXP2_SEL | B_AX_RXMIT_RXP1_SEL |
+		      FIELD_PREP(B_AX_RXCOUNTER_MATCH_MASK,
+				 min_t(u32, U8_MAX, prof->cnt)) |
+		      FIELD_PREP(B_AX_RXTIMER_UNIT_MASK, AX_RXTIMER_UNIT_64US) |
+		      FIELD_PREP(B_AX_RXTIMER_MATCH_MASK, prof->tmr_us / 64);
+
+	rtw89_write32(rtwdev, info->mit_addr, val);
+}
+
+static void rtw89_pci_rx_dim_reset(struct rtw89_pci *rtwpci)
+{
+	struct rtw89_pci_rx_ring *rx_ring = &rtwpci->rx_rings[RTW89_RXCH_RXQ];
+	struct rtw89_pci_rx_dim *dim = &rtwpci->rx_dim;
+
+	dim->start.time = ktime_get();
+	dim->start.pkts = rx_ring->rx_zc_cnt + rx_ring->rx_copy_cnt;
+	dim->start.bytes = rx_ring->rx_bytes;
+	dim->state = RTW89_PCI_RX_DIM_PARKING;
+	dim->polls = 0;
+	WRITE_ONCE(dim->prof_ix, 0);
+	/* registers are unknown after power on, so write them next time */
+	WRITE_ONCE(dim->applied_ix, U8_MAX);
+}
+
+u32 rtw89_pci_rx_mit_cnt_max(struct rtw89_dev *rtwdev)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+
+	return rtwpci->rx_rings[RTW89_RXCH_RXQ].bd_ring.len / 2;
+}
+
+/* Write the profile to registers. Called from both RX poll and track_work,
+ * so applied_ix and changes are only touched under irq_lock.
+ */
+static void rtw89_pci_rx_dim_apply(struct rtw89_dev *rtwdev,
+				   struct rtw89_pci *rtwpci, u8 ix)
+{
+	const struct rtw89_pci_gen_def *gen_def = rtwdev->pci_info->gen_def;
+	struct rtw89_pci_rx_dim *dim = &rtwpci->rx_dim;
+	struct rtw89_pci_rx_mit_prof prof;
+	unsigned long flags;
+
+	/* keep RX responsive to probe responses while scanning */
+	if (rtwdev->scanning)
+		ix = 0;
+
+	if (READ_ONCE(dim->applied_ix) == ix)
+		return;
+
+	prof = gen_def->rx_mit_profs[ix];
+	prof.cnt = min_t(u32, prof.cnt, rtw89_pci_rx_mit_cnt_max(rtwdev));
+
+	spin_lock_irqsave(&rtwpci->irq_lock, flags);
+	if (dim->applied_ix != ix) {
+		gen_def->rx_mit_set(rtwdev, &prof);
+		WRITE_ONCE(dim->applied_ix, ix);
+		dim->changes++;
+	}
+	spin_unlock_irqrestore(&rtwpci->irq_lock, flags);
+}
+
+/* only RX poll picks the profile */
+static void rtw89_pci_rx_dim_set(struct rtw89_dev *rtwdev,
+				 struct rtw89_pci *rtwpci, u8 ix)
+{
+	WRITE_ONCE(rtwpci->rx_dim.prof_ix, ix);
+	rtw89_pci_rx_dim_apply(rtwdev, rtwpci, ix);
+}
+
+enum rtw89_pci_rx_dim_cmp {
+	RTW89_PCI_RX_DIM_WORSE,
+	RTW89_PCI_RX_DIM_SAME,
+	RTW89_PCI_RX_DIM_BETTER,
+};
+
+/* differences within 10% are taken as the same */
+static enum rtw89_pci_rx_dim_cmp rtw89_pci_rx_dim_cmp_val(u32 curr, u32 prev)
+{
+	if ((u64)curr * 10 > (u64)prev * 11)
+		return RTW89_PCI_RX_DIM_BETTER;
+	if ((u64)curr * 10 < (u64)prev * 9)
+		return RTW89_PCI_RX_DIM_WORSE;
+
+	return RTW89_PCI_RX_DIM_SAME;
+}
+
+static u8 rtw89_pci_rx_dim_decide(struct rtw89_pci_rx_dim *dim,
+				  u32 ppms, u32 bpms)
+{
+	enum rtw89_pci_rx_dim_cmp cmp;
+	int ix = dim->prof_ix;
+
+	cmp = rtw89_pci_rx_dim_cmp_val(bpms, dim->bpms);
+	if (cmp == RTW89_PCI_RX_DIM_SAME)
+		cmp = rtw89_pci_rx_dim_cmp_val(ppms, dim->ppms);
+
+	switch (dim->state) {
+	case RTW89_PCI_RX_DIM_PARKING:
+		if (cmp == RTW89_PCI_RX_DIM_SAME)
+			return ix;
+
+		/* more traffic wants more moderation, and less wants less */
+		dim->state = cmp == RTW89_PCI_RX_DIM_BETTER ?
+			     RTW89_PCI_RX_DIM_GOING_RIGHT :
+			     RTW89_PCI_RX_DIM_GOING_LEFT;
+		break;
+	case RTW89_PCI_RX_DIM_GOING_LEFT:
+	case RTW89_PCI_RX_DIM_GOING_RIGHT:
+		if (cmp == RTW89_PCI_RX_DIM_SAME) {
+			dim->state = RTW89_PCI_RX_DIM_PARKING;
+			return ix;
+		}
+
+		/* last step made it worse, so turn around */
+		if (cmp == RTW89_PCI_RX_DIM_WORSE)
+			dim->state = dim->state == RTW89_PCI_RX_DIM_GOING_LEFT ?
+				     RTW89_PCI_RX_DIM_GOING_RIGHT :
+				     RTW89_PCI_RX_DIM_GOING_LEFT;
+		break;
+	}
+
+	ix += dim->state == RTW89_PCI_RX_DIM_GOING_RIGHT ? 1 : -1;
+	if (ix < 0 || ix >= RTW89_PCI_RX_DIM_NUM_PROFS) {
+		dim->state = RTW89_PCI_RX_DIM_PARKING;
+		return dim->prof_ix;
+	}
+
+	return ix;
+}
+
+static void rtw89_pci_rx_dim_update(struct rtw89_dev *rtwdev,
+				    struct rtw89_pci *rtwpci)
 {
-	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
-	unsigned long flags;
+	struct rtw89_pci_rx_ring *rx_ring = &rtwpci->rx_rings[RTW89_RXCH_RXQ];
+	struct rtw89_pci_rx_dim *dim = &rtwpci->rx_dim;
+	struct rtw89_pci_rx_dim_sample curr;
+	u64 pkts, bytes;
+	s64 delta_us;
+	u32 ppms, bpms;
+	u8 ix;
 
-	spin_lock_irqsave(&rtwpci->irq_lock, flags);
-	rtwpci->running = false;
-	rtw89_chip_disable_intr(rtwdev, rtwpci);
-	spin_unlock_irqrestore(&rtwpci->irq_lock, flags);
+	ix = READ_ONCE(dim->override);
+	if (ix != RTW89_PCI_RX_DIM_AUTO) {
+		rtw89_pci_rx_dim_set(rtwdev, rtwpci, ix);
+		return;
+	}
+
+	if (++dim->polls < RTW89_PCI_RX_DIM_NEVENTS)
+		return;
+
+	curr.time = ktime_get();
+	curr.pkts = rx_ring->rx_zc_cnt + rx_ring->rx_copy_cnt;
+	curr.bytes = rx_ring->rx_bytes;
+
+	delta_us = max_t(s64, ktime_us_delta(curr.time, dim->start.time), 1);
+	pkts = curr.pkts - dim->start.pkts;
+	bytes = curr.bytes - dim->start.bytes;
+	ppms = div64_u64(pkts * USEC_PER_MSEC, delta_us);
+	bpms = div64_u64(bytes * USEC_PER_MSEC, delta_us);
+
+	WRITE_ONCE(dim->windows[dim->prof_ix], dim->windows[dim->prof_ix] + 1);
+
+	/* few packets per poll: interrupts are cheap, go for latency */
+	if (pkts < (u64)dim->polls * RTW89_PCI_RX_DIM_LIGHT_PKTS) {
+		dim->state = RTW89_PCI_RX_DIM_PARKING;
+		ix = 0;
+	} else {
+		ix = rtw89_pci_rx_dim_decide(dim, ppms, bpms);
+	}
+
+	dim->start = curr;
+	dim->polls = 0;
+	dim->ppms = ppms;
+	dim->bpms = bpms;
+
+	rtw89_pci_rx_dim_set(rtwdev, rtwpci, ix);
 }
 
 static int rtw89_pci_ops_start(struct rtw89_dev *rtwdev)
 {
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+
+	rtw89_pci_rx_dim_reset(rtwpci);
 	rtw89_core_napi_start(rtwdev);
 	rtw89_pci_enable_intr_lock(rtwdev);
 
@@ -1709,8 +2678,7 @@ static void rtw89_pci_ops_pause(struct rtw89_dev *rtwdev, bool pause)
 	if (pause) {
 		rtw89_pci_disable_intr_lock(rtwdev);
 		synchronize_irq(pdev->irq);
-		if (test_bit(RTW89_FLAG_NAPI_RUNNING, rtwdev->flags))
-			napi_synchronize(&rtwdev->napi);
+		rtw89_core_napi_synchronize(rtwdev);
 	} else {
 		rtw89_pci_enable_intr_lock(rtwdev);
 		rtw89_pci_tx_kick_off_pending(rtwdev);
@@ -2836,6 +3804,12 @@ static int rtw89_pci_ops_mac_pre_init_ax(struct rtw89_dev *rtwdev)
 	rtw89_pci_clr_idx_all(rtwdev);
 	rtw89_pci_mode_op(rtwdev);
 
+	ret = rtw89_pci_apply_ring_cfg(rtwdev);
+	if (ret) {
+		rtw89_err(rtwdev, "[ERR] apply ring geometry\n");
+		return ret;
+	}
+
 	/* fill TRX BD indexes */
 	rtw89_pci_ops_reset(rtwdev);
 
@@ -3061,6 +4035,13 @@ static void rtw89_pci_free_tx_wd_ring(struct rtw89_dev *rtwdev,
 
 	dma_free_coherent(&pdev->dev, ring_sz, head, dma);
 	wd_ring->head = NULL;
+	kfree(wd_ring->free_stack);
+	wd_ring->free_stack = NULL;
+	wd_ring->busy_fifo = NULL;
+	kfree(wd_ring->segs);
+	wd_ring->segs = NULL;
+	kfree(wd_ring->pages);
+	wd_ring->pages = NULL;
 }
 
 static void rtw89_pci_free_tx_ring(struct rtw89_dev *rtwdev,
@@ -3116,7 +4097,8 @@ static void rtw89_pci_free_rx_ring(struct rtw89_dev *rtwdev,
 
 		rx_info = RTW89_PCI_RX_SKB_CB(skb);
 		dma = rx_info->dma;
-		dma_unmap_single(&pdev->dev, dma, buf_sz, DMA_FROM_DEVICE);
+		if (!rx_ring->page_pool)
+			dma_unmap_single(&pdev->dev, dma, buf_sz, DMA_FROM_DEVICE);
 		dev_kfree_skb(skb);
 		rx_ring->buf[i] = NULL;
 	}
@@ -3126,6 +4108,9 @@ static void rtw89_pci_free_rx_ring(struct rtw89_dev *rtwdev,
 	dma_free_coherent(&pdev->dev, ring_sz, head, dma);
 
 	rx_ring->bd_ring.head = NULL;
+	rtw89_pci_rx_zc_deinit(rx_ring);
+	kfree(rx_ring->buf);
+	rx_ring->buf = NULL;
 }
 
 static void rtw89_pci_free_rx_rings(struct rtw89_dev *rtwdev,
@@ -3153,22 +4138,26 @@ static int rtw89_pci_init_rx_bd(struct rtw89_dev *rtwdev, struct pci_dev *pdev,
 				struct sk_buff *skb, int buf_sz, u32 idx)
 {
 	struct rtw89_pci_rx_info *rx_info;
-	struct rtw89_pci_rx_bd_32 *rx_bd;
 	dma_addr_t dma;
 
 	if (!skb)
 		return -EINVAL;
 
-	dma = dma_map_single(&pdev->dev, skb->data, buf_sz, DMA_FROM_DEVICE);
-	if (dma_mapping_error(&pdev->dev, dma))
-		return -EBUSY;
-
 	rx_info = RTW89_PCI_RX_SKB_CB(skb);
-	rx_bd = RTW89_PCI_RX_BD(rx_ring, idx);
 
-	memset(rx_bd, 0, sizeof(*rx_bd));
-	rx_bd->buf_size = cpu_to_le16(buf_sz);
-	rx_bd->dma = cpu_to_le32(dma);
+	if (rx_ring->page_pool) {
+		/* already mapped by page pool */
+		dma = rx_info->dma;
+		dma_sync_single_for_device(&pdev->dev, dma, buf_sz,
+					   DMA_FROM_DEVICE);
+	} else {
+		dma = dma_map_single(&pdev->dev, skb->data, buf_sz,
+				     DMA_FROM_DEVICE);
+		if (dma_mapping_error(&pdev->dev, dma))
+			return -EBUSY;
+	}
+
+	rtw89_pci_fill_rx_bd(rx_ring, idx, dma, buf_sz);
 	rx_info->dma = dma;
 
 	return 0;
@@ -3179,6 +4168,7 @@ static int rtw89_pci_alloc_tx_wd_ring(struct rtw89_dev *rtwdev,
 				      struct rtw89_pci_tx_ring *tx_ring,
 				      enum rtw89_tx_channel txch)
 {
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
 	struct rtw89_pci_tx_wd_ring *wd_ring = &tx_ring->wd_ring;
 	struct rtw89_pci_tx_wd *txwd;
 	dma_addr_t dma;
@@ -3186,7 +4176,8 @@ static int rtw89_pci_alloc_tx_wd_ring(struct rtw89_dev *rtwdev,
 	u8 *head;
 	u8 *cur_vaddr;
 	u32 page_size = RTW89_PCI_TXWD_PAGE_SIZE;
-	u32 page_num = RTW89_PCI_TXWD_NUM_MAX;
+	u32 page_num = rtwpci->ring_cfg.txwd_num[txch];
+	u32 max_frags = rtwdev->hci.tx_max_frags;
 	u32 ring_sz = page_size * page_num;
 	u32 page_offset;
 	int i;
@@ -3195,11 +4186,30 @@ static int rtw89_pci_alloc_tx_wd_ring(struct rtw89_dev *rtwdev,
 	if (txch == RTW89_TXCH_CH12)
 		return 0;
 
+	wd_ring->pages = kcalloc(page_num, sizeof(*wd_ring->pages), GFP_KERNEL);
+	if (!wd_ring->pages)
+		return -ENOMEM;
+
+	wd_ring->free_stack = kcalloc(page_num * 2, sizeof(*wd_ring->free_stack),
+				      GFP_KERNEL);
+	if (!wd_ring->free_stack)
+		goto err_free_pages;
+
+	if (max_frags) {
+		wd_ring->segs = kcalloc(page_num * max_frags,
+					sizeof(*wd_ring->segs), GFP_KERNEL);
+		if (!wd_ring->segs)
+			goto err_free_stack;
+	}
+
 	head = dma_alloc_coherent(&pdev->dev, ring_sz, &dma, GFP_KERNEL);
 	if (!head)
-		return -ENOMEM;
+		goto err_free_segs;
 
-	INIT_LIST_HEAD(&wd_ring->free_pages);
+	wd_ring->busy_fifo = wd_ring->free_stack + page_num;
+	wd_ring->busy_head = 0;
+	wd_ring->busy_num = 0;
+	wd_ring->curr_num = 0;
 	wd_ring->head = head;
 	wd_ring->dma = dma;
 	wd_ring->page_size = page_size;
@@ -3212,17 +4222,29 @@ static int rtw89_pci_alloc_tx_wd_ring(struct rtw89_dev *rtwdev,
 		cur_vaddr = head + page_offset;
 
 		skb_queue_head_init(&txwd->queue);
-		INIT_LIST_HEAD(&txwd->list);
 		txwd->paddr = cur_paddr;
 		txwd->vaddr = cur_vaddr;
 		txwd->len = page_size;
 		txwd->seq = i;
+		txwd->segs = wd_ring->segs ? wd_ring->segs + i * max_frags : NULL;
 		rtw89_pci_enqueue_txwd(tx_ring, txwd);
 
 		page_offset += page_size;
 	}
 
 	return 0;
+
+err_free_segs:
+	kfree(wd_ring->segs);
+	wd_ring->segs = NULL;
+err_free_stack:
+	kfree(wd_ring->free_stack);
+	wd_ring->free_stack = NULL;
+err_free_pages:
+	kfree(wd_ring->pages);
+	wd_ring->pages = NULL;
+
+	return -ENOMEM;
 }
 
 static int rtw89_pci_alloc_tx_ring(struct rtw89_dev *rtwdev,
@@ -3255,7 +4277,6 @@ static int rtw89_pci_alloc_tx_ring(struct rtw89_dev *rtwdev,
 		goto err_free_wd_ring;
 	}
 
-	INIT_LIST_HEAD(&tx_ring->busy_pages);
 	tx_ring->bd_ring.head = head;
 	tx_ring->bd_ring.dma = dma;
 	tx_ring->bd_ring.len = len;
@@ -3264,6 +4285,8 @@ static int rtw89_pci_alloc_tx_ring(struct rtw89_dev *rtwdev,
 	tx_ring->bd_ring.wp = 0;
 	tx_ring->bd_ring.rp = 0;
 	tx_ring->txch = txch;
+	tx_ring->bd_hwm = 0;
+	tx_ring->wd_hwm = 0;
 
 	return 0;
 
@@ -3289,7 +4312,7 @@ static int rtw89_pci_alloc_tx_rings(struct rtw89_dev *rtwdev,
 			continue;
 		tx_ring = &rtwpci->tx_rings[i];
 		desc_size = sizeof(struct rtw89_pci_tx_bd_32);
-		len = RTW89_PCI_TXBD_NUM_MAX;
+		len = rtwpci->ring_cfg.txbd_num[i];
 		ret = rtw89_pci_alloc_tx_ring(rtwdev, pdev, tx_ring,
 					      desc_size, len, i);
 		if (ret) {
@@ -3303,7 +4326,10 @@ static int rtw89_pci_alloc_tx_rings(struct rtw89_dev *rtwdev,
 err_free:
 	tx_allocated = i;
 	for (i = 0; i < tx_allocated; i++) {
+		if (info->tx_dma_ch_mask & BIT(i))
+			continue;
 		tx_ring = &rtwpci->tx_rings[i];
+		rtw89_pci_free_tx_wd_ring(rtwdev, pdev, tx_ring);
 		rtw89_pci_free_tx_ring(rtwdev, pdev, tx_ring);
 	}
 
@@ -3331,10 +4357,16 @@ static int rtw89_pci_alloc_rx_ring(struct rtw89_dev *rtwdev,
 		return ret;
 	}
 
+	rx_ring->buf = kcalloc(len, sizeof(*rx_ring->buf), GFP_KERNEL);
+	if (!rx_ring->buf) {
+		ret = -ENOMEM;
+		goto err;
+	}
+
 	head = dma_alloc_coherent(&pdev->dev, ring_sz, &dma, GFP_KERNEL);
 	if (!head) {
 		ret = -ENOMEM;
-		goto err;
+		goto err_free_buf;
 	}
 
 	rx_ring->bd_ring.head = head;
@@ -3351,9 +4383,21 @@ static int rtw89_pci_alloc_rx_ring(struct rtw89_dev *rtwdev,
 	rx_ring->diliver_skb = NULL;
 	rx_ring->diliver_desc.ready = false;
 	rx_ring->target_rx_tag = 0;
+	rx_ring->page_pool = NULL;
+	rx_ring->bd_hwm = 0;
+
+	if (rxch == RTW89_RXCH_RXQ && !rtw89_pci_disable_rx_zc) {
+		ret = rtw89_pci_rx_zc_init(rtwdev, pdev, rx_ring, len);
+		if (ret)
+			rtw89_debug(rtwdev, RTW89_DBG_TXRX,
+				    "RX zero-copy is not available: %d\n", ret);
+	}
 
 	for (i = 0; i < len; i++) {
-		skb = dev_alloc_skb(buf_sz);
+		if (rx_ring->page_pool)
+			skb = rtw89_pci_rx_zc_alloc_skb(rx_ring, GFP_KERNEL);
+		else
+			skb = dev_alloc_skb(buf_sz);
 		if (!skb) {
 			ret = -ENOMEM;
 			goto err_free;
@@ -3380,7 +4424,8 @@ err_free:
 		if (!skb)
 			continue;
 		dma = *((dma_addr_t *)skb->cb);
-		dma_unmap_single(&pdev->dev, dma, buf_sz, DMA_FROM_DEVICE);
+		if (!rx_ring->page_pool)
+			dma_unmap_single(&pdev->dev, dma, buf_sz, DMA_FROM_DEVICE);
 		dev_kfree_skb(skb);
 		rx_ring->buf[i] = NULL;
 	}
@@ -3390,6 +4435,10 @@ err_free:
 	dma_free_coherent(&pdev->dev, ring_sz, head, dma);
 
 	rx_ring->bd_ring.head = NULL;
+	rtw89_pci_rx_zc_deinit(rx_ring);
+err_free_buf:
+	kfree(rx_ring->buf);
+	rx_ring->buf = NULL;
 err:
 	return ret;
 }
@@ -3407,7 +4456,7 @@ static int rtw89_pci_alloc_rx_rings(struct rtw89_dev *rtwdev,
 	for (i = 0; i < RTW89_RXCH_NUM; i++) {
 		rx_ring = &rtwpci->rx_rings[i];
 		desc_size = sizeof(struct rtw89_pci_rx_bd_32);
-		len = RTW89_PCI_RXBD_NUM_MAX;
+		len = rtwpci->ring_cfg.rxbd_num[i];
 		ret = rtw89_pci_alloc_rx_ring(rtwdev, pdev, rx_ring,
 					      desc_size, len, i);
 		if (ret) {
@@ -3453,6 +4502,99 @@ err:
 	return ret;
 }
 
+static void rtw89_pci_ring_cfg_init(struct rtw89_dev *rtwdev)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	struct rtw89_pci_ring_cfg *cfg = &rtwpci->ring_cfg;
+	int i;
+
+	for (i = 0; i < RTW89_TXCH_NUM; i++) {
+		cfg->txbd_num[i] = rtw89_pci_ring_num(rtw89_pci_txbd_num[i],
+						      RTW89_PCI_TXBD_NUM_DEF,
+						      RTW89_PCI_TXBD_NUM_MAX);
+		cfg->txwd_num[i] = rtw89_pci_ring_num(rtw89_pci_txwd_num[i],
+						      RTW89_PCI_TXWD_NUM_DEF,
+						      RTW89_PCI_TXWD_NUM_MAX);
+	}
+
+	for (i = 0; i < RTW89_RXCH_NUM; i++)
+		cfg->rxbd_num[i] = rtw89_pci_ring_num(rtw89_pci_rxbd_num[i],
+						      RTW89_PCI_RXBD_NUM_DEF,
+						      RTW89_PCI_RXBD_NUM_MAX);
+
+	rtwpci->ring_cfg_next = *cfg;
+	rtwpci->ring_cfg_pending = false;
+	rtw89_pci_calc_bd_ram(rtwdev);
+}
+
+/* Reallocate rings by ring_cfg_next set via debugfs. Called before filling
+ * BD indexes at power on, when DMA is stopped and NAPI is disabled.
+ *
+ * Rings of the new geometry are allocated while the old ones are kept aside,
+ * so a failure leaves the old geometry in place and the rings usable.
+ */
+int rtw89_pci_apply_ring_cfg(struct rtw89_dev *rtwdev)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	const struct rtw89_pci_info *info = rtwdev->pci_info;
+	struct pci_dev *pdev = rtwpci->pdev;
+	struct rtw89_pci_tx_ring *old_tx;
+	struct rtw89_pci_rx_ring *old_rx;
+	struct rtw89_pci_ring_cfg old;
+	int ret;
+	int i;
+
+	if (!rtwpci->ring_cfg_pending)
+		return 0;
+
+	rtwpci->ring_cfg_pending = false;
+	old = rtwpci->ring_cfg;
+
+	rtw89_pci_release_tx_rings(rtwdev);
+
+	old_tx = kmemdup(rtwpci->tx_rings, sizeof(rtwpci->tx_rings), GFP_KERNEL);
+	old_rx = kmemdup(rtwpci->rx_rings, sizeof(rtwpci->rx_rings), GFP_KERNEL);
+	if (!old_tx || !old_rx) {
+		ret = -ENOMEM;
+		goto err_restore_cfg;
+	}
+
+	rtwpci->ring_cfg = rtwpci->ring_cfg_next;
+	rtw89_pci_calc_bd_ram(rtwdev);
+	ret = rtw89_pci_alloc_trx_rings(rtwdev, pdev);
+	if (ret) {
+		memcpy(rtwpci->tx_rings, old_tx, sizeof(rtwpci->tx_rings));
+		memcpy(rtwpci->rx_rings, old_rx, sizeof(rtwpci->rx_rings));
+		goto err_restore_cfg;
+	}
+
+	for (i = 0; i < RTW89_TXCH_NUM; i++) {
+		if (info->tx_dma_ch_mask & BIT(i))
+			continue;
+		rtw89_pci_free_tx_wd_ring(rtwdev, pdev, &old_tx[i]);
+		rtw89_pci_free_tx_ring(rtwdev, pdev, &old_tx[i]);
+	}
+
+	for (i = 0; i < RTW89_RXCH_NUM; i++)
+		rtw89_pci_free_rx_ring(rtwdev, pdev, &old_rx[i]);
+
+	kfree(old_tx);
+	kfree(old_rx);
+
+	return 0;
+
+err_restore_cfg:
+	rtw89_warn(rtwdev, "failed to apply ring geometry, keep the old one\n");
+
+	kfree(old_tx);
+	kfree(old_rx);
+	rtwpci->ring_cfg = old;
+	rtwpci->ring_cfg_next = old;
+	rtw89_pci_calc_bd_ram(rtwdev);
+
+	return 0;
+}
+
 static void rtw89_pci_h2c_init(struct rtw89_dev *rtwdev,
 			       struct rtw89_pci *rtwpci)
 {
@@ -3465,6 +4607,7 @@ static int rtw89_pci_setup_resource(struct rtw89_dev *rtwdev,
 {
 	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
 	int ret;
+	int i;
 
 	ret = rtw89_pci_setup_mapping(rtwdev, pdev);
 	if (ret) {
@@ -3472,6 +4615,8 @@ static int rtw89_pci_setup_resource(struct rtw89_dev *rtwdev,
 		goto err;
 	}
 
+	rtw89_pci_ring_cfg_init(rtwdev);
+
 	ret = rtw89_pci_alloc_trx_rings(rtwdev, pdev);
 	if (ret) {
 		rtw89_err(rtwdev, "failed to alloc pci trx rings\n");
@@ -3481,7 +4626,11 @@ static int rtw89_pci_setup_resource(struct rtw89_dev *rtwdev,
 	rtw89_pci_h2c_init(rtwdev, rtwpci);
 
 	spin_lock_init(&rtwpci->irq_lock);
-	spin_lock_init(&rtwpci->trx_lock);
+	spin_lock_init(&rtwpci->rpq_lock);
+	for (i = 0; i < RTW89_TXCH_NUM; i++)
+		spin_lock_init(&rtwpci->tx_rings[i].lock);
+	init_waitqueue_head(&rtwpci->flush_wq);
+	rtwpci->rx_dim.override = RTW89_PCI_RX_DIM_AUTO;
 
 	return 0;
 
@@ -3516,6 +4665,8 @@ void rtw89_pci_config_intr_mask(struct rtw89_dev *rtwdev)
 	if (rtwpci->under_recovery) {
 		rtwpci->intrs[0] = hs0isr_ind_int_en;
 		rtwpci->intrs[1] = 0;
+		rtwpci->rxq_intrs[0] = 0;
+		rtwpci->rpq_intrs[0] = 0;
 	} else {
 		rtwpci->intrs[0] = B_AX_TXDMA_STUCK_INT_EN |
 				   B_AX_RXDMA_INT_EN |
@@ -3527,7 +4678,13 @@ void rtw89_pci_config_intr_mask(struct rtw89_dev *rtwdev)
 				   hs0isr_ind_int_en;
 
 		rtwpci->intrs[1] = B_AX_HC10ISR_IND_INT_EN;
+		rtwpci->rxq_intrs[0] = B_AX_RXDMA_INT_EN | B_AX_RXP1DMA_INT_EN;
+		rtwpci->rpq_intrs[0] = B_AX_RPQDMA_INT_EN | B_AX_RPQBD_FULL_INT_EN;
 	}
+	rtwpci->rxq_intrs[1] = 0;
+	rtwpci->rpq_intrs[1] = 0;
+	rtwpci->lp_intrs[0] = 0;
+	rtwpci->lp_intrs[1] = 0;
 }
 EXPORT_SYMBOL(rtw89_pci_config_intr_mask);
 
@@ -3539,6 +4696,8 @@ static void rtw89_pci_recovery_intr_mask_v1(struct rtw89_dev *rtwdev)
 	rtwpci->halt_c2h_intrs = B_AX_HALT_C2H_INT_EN | B_AX_WDT_TIMEOUT_INT_EN;
 	rtwpci->intrs[0] = 0;
 	rtwpci->intrs[1] = 0;
+	rtwpci->rxq_intrs[0] = 0;
+	rtwpci->rpq_intrs[0] = 0;
 }
 
 static void rtw89_pci_default_intr_mask_v1(struct rtw89_dev *rtwdev)
@@ -3557,6 +4716,8 @@ static void rtw89_pci_default_intr_mask_v1(struct rtw89_dev *rtwdev)
 			   B_AX_RDU_INT_EN |
 			   B_AX_RPQBD_FULL_INT_EN;
 	rtwpci->intrs[1] = B_AX_GPIO18_INT_EN;
+	rtwpci->rxq_intrs[0] = B_AX_RXDMA_INT_EN | B_AX_RXP1DMA_INT_EN;
+	rtwpci->rpq_intrs[0] = B_AX_RPQDMA_INT_EN | B_AX_RPQBD_FULL_INT_EN;
 }
 
 static void rtw89_pci_low_power_intr_mask_v1(struct rtw89_dev *rtwdev)
@@ -3568,18 +4729,27 @@ static void rtw89_pci_low_power_intr_mask_v1(struct rtw89_dev *rtwdev)
 	rtwpci->halt_c2h_intrs = B_AX_HALT_C2H_INT_EN | B_AX_WDT_TIMEOUT_INT_EN;
 	rtwpci->intrs[0] = 0;
 	rtwpci->intrs[1] = B_AX_GPIO18_INT_EN;
+	rtwpci->rxq_intrs[0] = 0;
+	rtwpci->rpq_intrs[0] = 0;
+	rtwpci->lp_intrs[1] = B_AX_GPIO18_INT_EN;
 }
 
 void rtw89_pci_config_intr_mask_v1(struct rtw89_dev *rtwdev)
 {
 	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
 
+	rtwpci->lp_intrs[0] = 0;
+	rtwpci->lp_intrs[1] = 0;
+
 	if (rtwpci->under_recovery)
 		rtw89_pci_recovery_intr_mask_v1(rtwdev);
 	else if (rtwpci->low_power)
 		rtw89_pci_low_power_intr_mask_v1(rtwdev);
 	else
 		rtw89_pci_default_intr_mask_v1(rtwdev);
+
+	rtwpci->rxq_intrs[1] = 0;
+	rtwpci->rpq_intrs[1] = 0;
 }
 EXPORT_SYMBOL(rtw89_pci_config_intr_mask_v1);
 
@@ -3591,6 +4761,8 @@ static void rtw89_pci_recovery_intr_mask_v2(struct rtw89_dev *rtwdev)
 	rtwpci->halt_c2h_intrs = B_BE_HALT_C2H_INT_EN | B_BE_WDT_TIMEOUT_INT_EN;
 	rtwpci->intrs[0] = 0;
 	rtwpci->intrs[1] = 0;
+	rtwpci->rxq_intrs[1] = 0;
+	rtwpci->rpq_intrs[1] = 0;
 }
 
 static void rtw89_pci_default_intr_mask_v2(struct rtw89_dev *rtwdev)
@@ -3604,6 +4776,8 @@ static void rtw89_pci_default_intr_mask_v2(struct rtw89_dev *rtwdev)
 			   B_BE_RDU_CH0_INT_IMR_V1;
 	rtwpci->intrs[1] = B_BE_PCIE_RX_RX0P2_IMR0_V1 |
 			   B_BE_PCIE_RX_RPQ0_IMR0_V1;
+	rtwpci->rxq_intrs[1] = B_BE_PCIE_RX_RX0P2_IMR0_V1;
+	rtwpci->rpq_intrs[1] = B_BE_PCIE_RX_RPQ0_IMR0_V1;
 }
 
 static void rtw89_pci_low_power_intr_mask_v2(struct rtw89_dev *rtwdev)
@@ -3616,18 +4790,28 @@ static void rtw89_pci_low_power_intr_mask_v2(struct rtw89_dev *rtwdev)
 	rtwpci->intrs[0] = 0;
 	rtwpci->intrs[1] = B_BE_PCIE_RX_RX0P2_IMR0_V1 |
 			   B_BE_PCIE_RX_RPQ0_IMR0_V1;
+	rtwpci->rxq_intrs[1] = 0;
+	rtwpci->rpq_intrs[1] = 0;
+	rtwpci->lp_intrs[1] = B_BE_PCIE_RX_RX0P2_IMR0_V1 |
+			      B_BE_PCIE_RX_RPQ0_IMR0_V1;
 }
 
 void rtw89_pci_config_intr_mask_v2(struct rtw89_dev *rtwdev)
 {
 	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
 
+	rtwpci->lp_intrs[0] = 0;
+	rtwpci->lp_intrs[1] = 0;
+
 	if (rtwpci->under_recovery)
 		rtw89_pci_recovery_intr_mask_v2(rtwdev);
 	else if (rtwpci->low_power)
 		rtw89_pci_low_power_intr_mask_v2(rtwdev);
 	else
 		rtw89_pci_default_intr_mask_v2(rtwdev);
+
+	rtwpci->rxq_intrs[0] = 0;
+	rtwpci->rpq_intrs[0] = 0;
 }
 EXPORT_SYMBOL(rtw89_pci_config_intr_mask_v2);
 
@@ -3841,27 +5025,11 @@ static void rtw89_pci_aspm_set_ax(struct rtw89_dev *rtwdev, bool enable)
 
 static void rtw89_pci_recalc_int_mit(struct rtw89_dev *rtwdev)
 {
-	enum rtw89_chip_gen chip_gen = rtwdev->chip->chip_gen;
-	const struct rtw89_pci_info *info = rtwdev->pci_info;
-	struct rtw89_traffic_stats *stats = &rtwdev->stats;
-	enum rtw89_tfc_lv tx_tfc_lv = stats->tx_tfc_lv;
-	enum rtw89_tfc_lv rx_tfc_lv = stats->rx_tfc_lv;
-	u32 val = 0;
-
-	if (rtwdev->scanning ||
-	    (tx_tfc_lv < RTW89_TFC_HIGH && rx_tfc_lv < RTW89_TFC_HIGH))
-		goto out;
-
-	if (chip_gen == RTW89_CHIP_BE)
-		val = B_BE_PCIE_MIT_RX0P2_EN | B_BE_PCIE_MIT_RX0P1_EN;
-	else
-		val = B_AX_RXMIT_RXP2_SEL | B_AX_RXMIT_RXP1_SEL |
-		      FIELD_PREP(B_AX_RXCOUNTER_MATCH_MASK, RTW89_PCI_RXBD_NUM_MAX / 2) |
-		      FIELD_PREP(B_AX_RXTIMER_UNIT_MASK, AX_RXTIMER_UNIT_64US) |
-		      FIELD_PREP(B_AX_RXTIMER_MATCH_MASK, 2048 / 64);
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	struct rtw89_pci_rx_dim *dim = &rtwpci->rx_dim;
 
-out:
-	rtw89_write32(rtwdev, info->mit_addr, val);
+	/* profile is tuned by rtw89_pci_rx_dim_update() in each RX poll */
+	rtw89_pci_rx_dim_apply(rtwdev, rtwpci, READ_ONCE(dim->prof_ix));
 }
 
 static void rtw89_pci_link_cfg(struct rtw89_dev *rtwdev)
@@ -4076,30 +5244,72 @@ static void rtw89_pci_ops_dump_err_status(struct rtw89_dev *rtwdev)
 	}
 }
 
+/* Under low power, one interrupt wakes up both RX and TX completion, and
+ * traffic is light, so serve them in one poll with a small budget.
+ */
+static int rtw89_pci_napi_poll_low_power(struct rtw89_dev *rtwdev,
+					 struct rtw89_pci *rtwpci,
+					 struct napi_struct *napi, int budget)
+{
+	int lp_budget = min(budget, RTW89_PCI_LOW_POWER_NAPI_BUDGET);
+	int work_done;
+
+	/* To prevent RXQ get stuck due to run out of budget. */
+	rtwdev->napi_budget_countdown = lp_budget;
+
+	rtw89_pci_poll_rpq_dma(rtwdev, rtwpci, lp_budget);
+	work_done = rtw89_pci_poll_rxq_dma(rtwdev, rtwpci, lp_budget);
+	rtw89_core_napi_rx_flush(rtwdev);
+	trace_rtw89_pci_napi_poll(rtwdev, RTW89_TRACE_NAPI_LOW_POWER, lp_budget,
+				  work_done);
+
+	/* ask to be polled again by claiming the whole budget */
+	if (work_done >= lp_budget)
+		return budget;
+
+	if (napi_complete_done(napi, work_done))
+		rtw89_pci_napi_unmask_intrs(rtwdev, rtwpci, rtwpci->lp_intrs);
+
+	return work_done;
+}
+
 static int rtw89_pci_napi_poll(struct napi_struct *napi, int budget)
 {
 	struct rtw89_dev *rtwdev = container_of(napi, struct rtw89_dev, napi);
 	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
 	const struct rtw89_pci_info *info = rtwdev->pci_info;
 	const struct rtw89_pci_gen_def *gen_def = info->gen_def;
-	unsigned long flags;
 	int work_done;
 
-	rtwdev->napi_budget_countdown = budget;
+	if (unlikely(rtwpci->low_power))
+		return rtw89_pci_napi_poll_low_power(rtwdev, rtwpci, napi, budget);
 
-	rtw89_write32(rtwdev, gen_def->isr_clear_rpq.addr, gen_def->isr_clear_rpq.data);
-	work_done = rtw89_pci_poll_rpq_dma(rtwdev, rtwpci, rtwdev->napi_budget_countdown);
-	if (work_done == budget)
-		return budget;
+	rtwdev->napi_budget_countdown = budget;
 
 	rtw89_write32(rtwdev, gen_def->isr_clear_rxq.addr, gen_def->isr_clear_rxq.data);
-	work_done += rtw89_pci_poll_rxq_dma(rtwdev, rtwpci, rtwdev->napi_budget_countdown);
-	if (work_done < budget && napi_complete_done(napi, work_done)) {
-		spin_lock_irqsave(&rtwpci->irq_lock, flags);
-		if (likely(rtwpci->running))
-			rtw89_chip_enable_intr(rtwdev, rtwpci);
-		spin_unlock_irqrestore(&rtwpci->irq_lock, flags);
-	}
+	work_done = rtw89_pci_poll_rxq_dma(rtwdev, rtwpci, budget);
+	rtw89_core_napi_rx_flush(rtwdev);
+	rtw89_pci_rx_dim_update(rtwdev, rtwpci);
+	trace_rtw89_pci_napi_poll(rtwdev, RTW89_TRACE_NAPI_RXQ, budget, work_done);
+	if (work_done < budget && napi_complete_done(napi, work_done))
+		rtw89_pci_napi_unmask_intrs(rtwdev, rtwpci, rtwpci->rxq_intrs);
+
+	return work_done;
+}
+
+static int rtw89_pci_napi_poll_tx(struct napi_struct *napi, int budget)
+{
+	struct rtw89_dev *rtwdev = container_of(napi, struct rtw89_dev, napi_tx);
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	const struct rtw89_pci_info *info = rtwdev->pci_info;
+	const struct rtw89_pci_gen_def *gen_def = info->gen_def;
+	int work_done;
+
+	rtw89_write32(rtwdev, gen_def->isr_clear_rpq.addr, gen_def->isr_clear_rpq.data);
+	work_done = rtw89_pci_poll_rpq_dma(rtwdev, rtwpci, budget);
+	trace_rtw89_pci_napi_poll(rtwdev, RTW89_TRACE_NAPI_RPQ, budget, work_done);
+	if (work_done < budget && napi_complete_done(napi, work_done))
+		rtw89_pci_napi_unmask_intrs(rtwdev, rtwpci, rtwpci->rpq_intrs);
 
 	return work_done;
 }
@@ -4194,9 +5404,231 @@ const struct rtw89_pci_gen_def rtw89_pci_gen_ax = {
 	.aspm_set = rtw89_pci_aspm_set_ax,
 	.clkreq_set = rtw89_pci_clkreq_set_ax,
 	.l1ss_set = rtw89_pci_l1ss_set_ax,
+
+	.rx_mit_profs = rtw89_pci_rx_mit_profs_ax,
+	.rx_mit_set = rtw89_pci_rx_mit_set_ax,
 };
 EXPORT_SYMBOL(rtw89_pci_gen_ax);
 
+static void rtw89_pci_dump_rx_stats(struct rtw89_pci *rtwpci, struct seq_file *m)
+{
+	struct rtw89_pci_rx_ring *rx_ring;
+	int i;
+
+	seq_puts(m, "RX rings:\n");
+
+	for (i = 0; i < RTW89_RXCH_NUM; i++) {
+		rx_ring = &rtwpci->rx_rings[i];
+
+		seq_printf(m, "\t[%d] zero-copy=%s zc=%llu copy=%llu zc_alloc_fail=%llu\n",
+			   i, rx_ring->page_pool ? "on" : "off",
+			   rx_ring->rx_zc_cnt, rx_ring->rx_copy_cnt,
+			   rx_ring->rx_zc_alloc_fail);
+	}
+}
+
+static void rtw89_pci_dump_tx_stats(struct rtw89_dev *rtwdev,
+				    struct rtw89_pci *rtwpci, struct seq_file *m)
+{
+	const struct rtw89_pci_info *info = rtwdev->pci_info;
+	u64 band_tx[RTW89_MAC_1 + 1] = {}, band_full[RTW89_MAC_1 + 1] = {};
+	struct rtw89_pci_tx_ring *tx_ring;
+	u64 per_mille, quot;
+	u32 rem;
+	u8 band;
+	int i;
+
+	seq_puts(m, "TX rings:\n");
+
+	for (i = 0; i < RTW89_TXCH_NUM; i++) {
+		if (info->tx_dma_ch_mask & BIT(i))
+			continue;
+
+		tx_ring = &rtwpci->tx_rings[i];
+		per_mille = tx_ring->tx_cnt ?
+			    div64_u64(tx_ring->kick_cnt * 1000, tx_ring->tx_cnt) : 0;
+		quot = div_u64_rem(per_mille, 1000, &rem);
+
+		seq_printf(m, "\t[%d] tx=%llu sg=%llu full=%llu doorbell=%llu doorbell/pkt=%llu.%03u\n",
+			   i, tx_ring->tx_cnt, tx_ring->tx_sg_cnt,
+			   tx_ring->tx_full_cnt, tx_ring->kick_cnt, quot, rem);
+
+		if (i == RTW89_TXCH_CH12)
+			continue;
+
+		band = rtw89_pci_txch_band(i);
+		band_tx[band] += tx_ring->tx_cnt;
+		band_full[band] += tx_ring->tx_full_cnt;
+	}
+
+	for (band = RTW89_MAC_0; band <= RTW89_MAC_1; band++)
+		seq_printf(m, "\tband%u: tx=%llu full=%llu\n",
+			   band, band_tx[band], band_full[band]);
+}
+
+static void rtw89_pci_dump_lock_stats(struct rtw89_dev *rtwdev,
+				      struct rtw89_pci *rtwpci, struct seq_file *m)
+{
+	const struct rtw89_pci_info *info = rtwdev->pci_info;
+	struct rtw89_pci_tx_ring *tx_ring;
+	int i;
+
+	seq_puts(m, "Locks (acquired/contended):\n");
+
+	for (i = 0; i < RTW89_TXCH_NUM; i++) {
+		if (info->tx_dma_ch_mask & BIT(i))
+			continue;
+
+		tx_ring = &rtwpci->tx_rings[i];
+		seq_printf(m, "\ttx_ring[%d]: %llu/%llu\n", i,
+			   tx_ring->lock_acquired, tx_ring->lock_contended);
+	}
+
+	seq_printf(m, "\trpq: %llu/%llu\n",
+		   rtwpci->rpq_lock_acquired, rtwpci->rpq_lock_contended);
+}
+
+static void rtw89_pci_dump_flush_stats(struct rtw89_pci *rtwpci,
+				       struct seq_file *m)
+{
+	const struct rtw89_pci_flush_stats *stats = &rtwpci->flush_stats;
+	u64 avg = stats->cnt ? div64_u64(stats->total_us, stats->cnt) : 0;
+
+	seq_printf(m, "flush: cnt=%llu timeout=%llu avg=%lluus max=%lluus\n",
+		   stats->cnt, stats->timeout, avg, stats->max_us);
+	seq_printf(m, "flush without wait: drop=%llu paused=%llu\n",
+		   stats->drop, stats->paused);
+}
+
+static void rtw89_pci_ops_dump_stats(struct rtw89_dev *rtwdev,
+				     struct seq_file *m)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+
+	rtw89_pci_dump_rx_stats(rtwpci, m);
+	rtw89_pci_dump_tx_stats(rtwdev, rtwpci, m);
+	rtw89_pci_dump_lock_stats(rtwdev, rtwpci, m);
+	rtw89_pci_dump_flush_stats(rtwpci, m);
+}
+
+static void rtw89_pci_ops_dump_rx_mit(struct rtw89_dev *rtwdev,
+				      struct seq_file *m)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	const struct rtw89_pci_rx_mit_prof *prof;
+	struct rtw89_pci_rx_dim *dim = &rtwpci->rx_dim;
+	u32 cnt_max = rtw89_pci_rx_mit_cnt_max(rtwdev);
+	u8 applied_ix = READ_ONCE(dim->applied_ix);
+	int i;
+
+	prof = rtwdev->pci_info->gen_def->rx_mit_profs;
+
+	if (dim->override == RTW89_PCI_RX_DIM_AUTO)
+		seq_puts(m, "mode: auto\n");
+	else
+		seq_printf(m, "mode: fixed profile %u\n", dim->override);
+
+	seq_printf(m, "profile: %u (applied %d)\n", READ_ONCE(dim->prof_ix),
+		   applied_ix == U8_MAX ? -1 : applied_ix);
+	seq_printf(m, "last window: %u pkts/ms %u bytes/ms\n",
+		   dim->ppms, dim->bpms);
+	seq_printf(m, "profile changes: %llu\n", dim->changes);
+
+	for (i = 0; i < RTW89_PCI_RX_DIM_NUM_PROFS; i++)
+		seq_printf(m, "\t[%d] cnt=%u tmr=%uus windows=%llu\n", i,
+			   min_t(u32, prof[i].cnt, cnt_max), prof[i].tmr_us,
+			   READ_ONCE(dim->windows[i]));
+
+	seq_printf(m, "write profile index to fix it, or %d for auto\n",
+		   RTW89_PCI_RX_DIM_NUM_PROFS);
+}
+
+static int rtw89_pci_ops_set_rx_mit(struct rtw89_dev *rtwdev, u32 ix)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+
+	/* applied by the next RX poll */
+	if (ix >= RTW89_PCI_RX_DIM_NUM_PROFS)
+		WRITE_ONCE(rtwpci->rx_dim.override, RTW89_PCI_RX_DIM_AUTO);
+	else
+		WRITE_ONCE(rtwpci->rx_dim.override, ix);
+
+	return 0;
+}
+
+static void rtw89_pci_ops_dump_rings(struct rtw89_dev *rtwdev,
+				     struct seq_file *m)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	const struct rtw89_pci_ring_cfg *next = &rtwpci->ring_cfg_next;
+	const struct rtw89_pci_info *info = rtwdev->pci_info;
+	const struct rtw89_pci_bd_ram *bd_ram;
+	struct rtw89_pci_tx_ring *tx_ring;
+	struct rtw89_pci_rx_ring *rx_ring;
+	int i;
+
+	lockdep_assert_held(&rtwdev->mutex);
+
+	seq_puts(m, "TX rings (BD used/hwm/num, WD used/hwm/num, BD-RAM start/max/min):\n");
+	for (i = 0; i < RTW89_TXCH_NUM; i++) {
+		if (info->tx_dma_ch_mask & BIT(i))
+			continue;
+
+		tx_ring = &rtwpci->tx_rings[i];
+		bd_ram = &rtwpci->bd_ram[i];
+		seq_printf(m, "\t[%d] bd %u/%u/%u wd %u/%u/%u bdram %u/%u/%u",
+			   i, (tx_ring->bd_ring.wp - tx_ring->bd_ring.rp +
+			       tx_ring->bd_ring.len) % tx_ring->bd_ring.len,
+			   tx_ring->bd_hwm, tx_ring->bd_ring.len,
+			   tx_ring->wd_ring.page_num - tx_ring->wd_ring.curr_num,
+			   tx_ring->wd_hwm, tx_ring->wd_ring.page_num,
+			   bd_ram->start_idx, bd_ram->max_num, bd_ram->min_num);
+		if (rtwpci->ring_cfg_pending)
+			seq_printf(m, " next bd %u wd %u",
+				   next->txbd_num[i], next->txwd_num[i]);
+		seq_puts(m, "\n");
+	}
+
+	seq_puts(m, "RX rings (BD hwm/num):\n");
+	for (i = 0; i < RTW89_RXCH_NUM; i++) {
+		rx_ring = &rtwpci->rx_rings[i];
+		seq_printf(m, "\t[%d] bd %u/%u", i, rx_ring->bd_hwm,
+			   rx_ring->bd_ring.len);
+		if (rtwpci->ring_cfg_pending)
+			seq_printf(m, " next bd %u", next->rxbd_num[i]);
+		seq_puts(m, "\n");
+	}
+}
+
+static int rtw89_pci_ops_set_rings(struct rtw89_dev *rtwdev, bool tx, u32 ch,
+				   u32 bd, u32 wd)
+{
+	struct rtw89_pci *rtwpci = (struct rtw89_pci *)rtwdev->priv;
+	struct rtw89_pci_ring_cfg *next = &rtwpci->ring_cfg_next;
+	const struct rtw89_pci_info *info = rtwdev->pci_info;
+
+	lockdep_assert_held(&rtwdev->mutex);
+
+	if (tx) {
+		if (ch >= RTW89_TXCH_NUM || info->tx_dma_ch_mask & BIT(ch))
+			return -EINVAL;
+
+		next->txbd_num[ch] = rtw89_pci_ring_num(bd, RTW89_PCI_TXBD_NUM_DEF,
+							RTW89_PCI_TXBD_NUM_MAX);
+		next->txwd_num[ch] = rtw89_pci_ring_num(wd, RTW89_PCI_TXWD_NUM_DEF,
+							RTW89_PCI_TXWD_NUM_MAX);
+	} else {
+		if (ch >= RTW89_RXCH_NUM)
+			return -EINVAL;
+
+		next->rxbd_num[ch] = rtw89_pci_ring_num(bd, RTW89_PCI_RXBD_NUM_DEF,
+							RTW89_PCI_RXBD_NUM_MAX);
+	}
+	rtwpci->ring_cfg_pending = true;
+
+	return 0;
+}
+
 static const struct rtw89_hci_ops rtw89_pci_ops = {
 	.tx_write	= rtw89_pci_ops_tx_write,
 	.tx_kick_off	= rtw89_pci_ops_tx_kick_off,
@@ -4224,6 +5656,7 @@ static const struct rtw89_hci_ops rtw89_pci_ops = {
 	.mac_lv1_rcvy	= rtw89_pci_ops_mac_lv1_recovery,
 	.dump_err_status = rtw89_pci_ops_dump_err_status,
 	.napi_poll	= rtw89_pci_napi_poll,
+	.napi_poll_tx	= rtw89_pci_napi_poll_tx,
 
 	.recovery_start = rtw89_pci_ops_recovery_start,
 	.recovery_complete = rtw89_pci_ops_recovery_complete,
@@ -4238,6 +5671,12 @@ static const struct rtw89_hci_ops rtw89_pci_ops = {
 	.disable_intr	= rtw89_pci_disable_intr_lock,
 	.enable_intr	= rtw89_pci_enable_intr_lock,
 	.rst_bdram	= rtw89_pci_reset_bdram,
+
+	.dump_stats	= rtw89_pci_ops_dump_stats,
+	.dump_rx_mit	= rtw89_pci_ops_dump_rx_mit,
+	.set_rx_mit	= rtw89_pci_ops_set_rx_mit,
+	.dump_rings	= rtw89_pci_ops_dump_rings,
+	.set_rings	= rtw89_pci_ops_set_rings,
 };
 
 int rtw89_pci_probe(struct pci_dev *pdev, const struct pci_device_id *id)
@@ -4264,6 +5703,8 @@ int rtw89_pci_probe(struct pci_dev *pdev, const struct pci_device_id *id)
 	rtwdev->hci.type = RTW89_HCI_TYPE_PCIE;
 	rtwdev->hci.rpwm_addr = pci_info->rpwm_addr;
 	rtwdev->hci.cpwm_addr = pci_info->cpwm_addr;
+	if (pci_info->fill_txaddr_info_sg)
+		rtwdev->hci.tx_max_frags = rtw89_pci_tx_addr_info_max_nr(rtwdev->chip);
 
 	rtw89_check_quirks(rtwdev, info->quirks);
 
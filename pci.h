@@ -7,6 +7,8 @@
 
 #include "txrx.h"
 
+struct page_pool;
+
 #define MDIO_PG0_G1 0
 #define MDIO_PG1_G1 1
 #define MDIO_PG0_G2 2
@@ -1024,12 +1026,36 @@
 #define B_BE_FORCE_EN_DMA_TX_GCLK BIT(4)
 #define B_BE_MAX_TAG_NUM_MASK GENMASK(3, 0)
 
-#define RTW89_PCI_TXBD_NUM_MAX		256
-#define RTW89_PCI_RXBD_NUM_MAX		256
-#define RTW89_PCI_TXWD_NUM_MAX		512
+#define RTW89_PCI_TXBD_NUM_DEF		256
+#define RTW89_PCI_RXBD_NUM_DEF		256
+#define RTW89_PCI_TXWD_NUM_DEF		512
+#define RTW89_PCI_TXBD_NUM_MAX		1024
+#define RTW89_PCI_RXBD_NUM_MAX		1024
+#define RTW89_PCI_TXWD_NUM_MAX		2048
+#define RTW89_PCI_RING_NUM_MIN		16
+#define RTW89_PCI_FLUSH_TIMEOUT_MS	20
+#define RTW89_PCI_FLUSH_SHORT_TIMEOUT_US 200
+#define RTW89_PCI_LOW_POWER_NAPI_BUDGET	16
 #define RTW89_PCI_TXWD_PAGE_SIZE	128
 #define RTW89_PCI_ADDRINFO_MAX		4
 #define RTW89_PCI_RX_BUF_SIZE		(11454 + 40) /* +40 for rtw89_rxdesc_long_v2 */
+#define RTW89_PCI_RX_ZC_HEADROOM	NET_SKB_PAD
+/* A zero-copy frame holds a whole RX buffer, which is charged to socket
+ * as truesize of an order-2 page, so only near-MTU frames and A-MSDUs
+ * are worth it. Smaller frames are copied.
+ */
+#define RTW89_PCI_RX_COPYBREAK		1024
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 15, 0) && IS_ENABLED(CONFIG_PAGE_POOL)
+#define RTW89_PCI_RX_PAGE_POOL
+#endif
+
+#define RTW89_PCI_RX_DIM_NUM_PROFS	5
+#define RTW89_PCI_RX_DIM_AUTO		U8_MAX
+#define RTW89_PCI_RX_DIM_NEVENTS	64
+#define RTW89_PCI_RX_DIM_LIGHT_PKTS	2
+/* RX mitigation count of half the active RXQ ring */
+#define RTW89_PCI_RX_MIT_CNT_HALF_RING	U16_MAX
 
 #define RTW89_PCI_POLL_BDRAM_RST_CNT	100
 #define RTW89_PCI_MULTITAG		8
@@ -1241,6 +1267,15 @@ struct rtw89_pci_bd_ram {
 	u8 min_num;
 };
 
+/* RX interrupt is raised after @cnt packets or @tmr_us since the first one.
+ * A profile with zero @cnt disables moderation, and @cnt is capped by half
+ * of the active RXQ ring, which is what RTW89_PCI_RX_MIT_CNT_HALF_RING asks.
+ */
+struct rtw89_pci_rx_mit_prof {
+	u16 cnt;
+	u16 tmr_us;
+};
+
 struct rtw89_pci_gen_def {
 	u32 isr_rdu;
 	u32 isr_halt_c2h;
@@ -1265,6 +1300,17 @@ struct rtw89_pci_gen_def {
 	void (*aspm_set)(struct rtw89_dev *rtwdev, bool enable);
 	void (*clkreq_set)(struct rtw89_dev *rtwdev, bool enable);
 	void (*l1ss_set)(struct rtw89_dev *rtwdev, bool enable);
+
+	/* profiles in order of increasing moderation */
+	const struct rtw89_pci_rx_mit_prof *rx_mit_profs;
+	void (*rx_mit_set)(struct rtw89_dev *rtwdev,
+			   const struct rtw89_pci_rx_mit_prof *prof);
+};
+
+struct rtw89_pci_tx_seg {
+	dma_addr_t dma;
+	u32 len;
+	bool page;
 };
 
 struct rtw89_pci_info {
@@ -1313,6 +1359,11 @@ struct rtw89_pci_info {
 	u32 (*fill_txaddr_info)(struct rtw89_dev *rtwdev,
 				void *txaddr_info_addr, u32 total_len,
 				dma_addr_t dma, u8 *add_info_nr);
+	/* optional; chips without it take linear skb only */
+	u32 (*fill_txaddr_info_sg)(struct rtw89_dev *rtwdev,
+				   void *txaddr_info_addr,
+				   const struct rtw89_pci_tx_seg *segs,
+				   u8 nr_segs, u8 *add_info_nr);
 	void (*config_intr_mask)(struct rtw89_dev *rtwdev);
 	void (*enable_intr)(struct rtw89_dev *rtwdev, struct rtw89_pci *rtwpci);
 	void (*disable_intr)(struct rtw89_dev *rtwdev, struct rtw89_pci *rtwpci);
@@ -1400,13 +1451,29 @@ struct rtw89_pci_rxbd_info {
 };
 
 struct rtw89_pci_tx_wd {
-	struct list_head list;
+	bool queued; /* on free stack or busy FIFO of wd_ring */
 	struct sk_buff_head queue;
 
 	void *vaddr;
 	dma_addr_t paddr;
 	u32 len;
 	u32 seq;
+
+	/* mapped buffers of a nonlinear skb, nr_segs is 0 if skb is linear.
+	 * segs points into rtw89_pci_tx_wd_ring::segs, NULL without SG.
+	 */
+	struct rtw89_pci_tx_seg *segs;
+	u8 nr_segs;
+
+	u8 mac_id;
+	/* charged as TX airtime of the station on release, 0 if not data */
+	u8 tid;
+	u16 airtime_len;
+
+	/* TX latency sampling, enqueue_ts is 0 if the frame isn't sampled */
+	ktime_t enqueue_ts;
+	ktime_t kick_ts;
+	u8 ac;
 };
 
 struct rtw89_pci_dma_ring {
@@ -1425,8 +1492,17 @@ struct rtw89_pci_tx_wd_ring {
 	void *head;
 	dma_addr_t dma;
 
-	struct rtw89_pci_tx_wd pages[RTW89_PCI_TXWD_NUM_MAX];
-	struct list_head free_pages;
+	struct rtw89_pci_tx_wd *pages;
+	/* Indexes of free pages as a stack, so a recycled page is reused while
+	 * its cache lines are hot, and indexes of pages whose TX BD is not
+	 * reclaimed yet as a FIFO in BD order.
+	 */
+	u16 *free_stack;
+	u16 *busy_fifo;
+	u32 busy_head;
+	u32 busy_num;
+	/* hci.tx_max_frags entries for each page, only if TX SG is supported */
+	struct rtw89_pci_tx_seg *segs;
 
 	u32 page_size;
 	u32 page_num;
@@ -1438,12 +1514,25 @@ struct rtw89_pci_tx_wd_ring {
 struct rtw89_pci_tx_ring {
 	struct rtw89_pci_tx_wd_ring wd_ring;
 	struct rtw89_pci_dma_ring bd_ring;
-	struct list_head busy_pages;
 	u8 txch;
 	bool dma_enabled;
 	u16 tag; /* range from 0x0001 ~ 0x1fff */
 
+	/* protect BD and WD resources of this channel */
+	spinlock_t lock;
+	u64 lock_acquired;
+	u64 lock_contended;
+
+	/* most BDs and WD pages in use at the same time */
+	u32 bd_hwm;
+	u32 wd_hwm;
+
+	u64 kick_cnt;
+	/* sampled frames written since the last doorbell */
+	u32 unkicked;
 	u64 tx_cnt;
+	u64 tx_sg_cnt;
+	u64 tx_full_cnt; /* no BD or WD left after reclaim */
 	u64 tx_acked;
 	u64 tx_retry_lmt;
 	u64 tx_life_time;
@@ -1452,11 +1541,69 @@ struct rtw89_pci_tx_ring {
 
 struct rtw89_pci_rx_ring {
 	struct rtw89_pci_dma_ring bd_ring;
-	struct sk_buff *buf[RTW89_PCI_RXBD_NUM_MAX];
+	struct sk_buff **buf;
 	u32 buf_sz;
+	u32 bd_hwm; /* most BDs filled by device at the same time */
 	struct sk_buff *diliver_skb;
 	struct rtw89_rx_desc_info diliver_desc;
 	u32 target_rx_tag:13;
+
+	/* non-NULL if buffers of this ring are handed up without copying */
+	struct page_pool *page_pool;
+	u64 rx_zc_cnt;
+	u64 rx_copy_cnt;
+	u64 rx_zc_alloc_fail;
+	u64 rx_bytes;
+};
+
+enum rtw89_pci_rx_dim_state {
+	RTW89_PCI_RX_DIM_PARKING,
+	RTW89_PCI_RX_DIM_GOING_LEFT,
+	RTW89_PCI_RX_DIM_GOING_RIGHT,
+};
+
+struct rtw89_pci_rx_dim_sample {
+	ktime_t time;
+	u64 pkts;
+	u64 bytes;
+};
+
+/* Dynamic RX interrupt moderation. Every RTW89_PCI_RX_DIM_NEVENTS RX polls
+ * compare throughput with the previous window, and step through profiles
+ * of gen_def->rx_mit_profs in the direction that improves it.
+ */
+struct rtw89_pci_rx_dim {
+	struct rtw89_pci_rx_dim_sample start;
+	u32 polls;
+	u32 ppms; /* packets per ms of last window */
+	u32 bpms; /* bytes per ms of last window */
+	enum rtw89_pci_rx_dim_state state;
+	u8 prof_ix;
+	u8 applied_ix;
+	u8 override; /* fixed profile index, or RTW89_PCI_RX_DIM_AUTO */
+
+	u64 windows[RTW89_PCI_RX_DIM_NUM_PROFS];
+	u64 changes;
+};
+
+/* Number of BDs and WD pages of each channel */
+struct rtw89_pci_ring_cfg {
+	u16 txbd_num[RTW89_TXCH_NUM];
+	u16 txwd_num[RTW89_TXCH_NUM];
+	u16 rxbd_num[RTW89_RXCH_NUM];
+};
+
+/* Latency of flush_queues calls, until every TX WD of the requested
+ * channels is released by RPP. Flushes to drop frames, or while HCI is
+ * paused, don't wait and are counted apart.
+ */
+struct rtw89_pci_flush_stats {
+	u64 cnt;
+	u64 timeout;
+	u64 total_us;
+	u64 max_us;
+	u64 drop;
+	u64 paused;
 };
 
 struct rtw89_pci_isrs {
@@ -1470,8 +1617,13 @@ struct rtw89_pci {
 
 	/* protect HW irq related registers */
 	spinlock_t irq_lock;
-	/* protect TRX resources (exclude RXQ) */
-	spinlock_t trx_lock;
+	/* Protect RPQ ring. TX resources are protected by lock of each
+	 * tx_ring. Lock order is rpq_lock -> tx_ring->lock, and never hold
+	 * locks of two tx_rings at the same time.
+	 */
+	spinlock_t rpq_lock;
+	u64 rpq_lock_acquired;
+	u64 rpq_lock_contended;
 	bool running;
 	bool low_power;
 	bool under_recovery;
@@ -1484,9 +1636,33 @@ struct rtw89_pci {
 	u32 ind_intrs;
 	u32 halt_c2h_intrs;
 	u32 intrs[2];
+	/* bits in intrs[] served by RX and TX completion NAPI respectively */
+	u32 rxq_intrs[2];
+	u32 rpq_intrs[2];
+	/* bits in intrs[] of low power mode, where RX NAPI serves RPQ too */
+	u32 lp_intrs[2];
+	/* bits in intrs[] held off while their NAPI is scheduled */
+	u32 napi_masked_intrs[2];
+	struct rtw89_pci_rx_dim rx_dim;
+	/* woken up from release path to check progress of flush_queues */
+	wait_queue_head_t flush_wq;
+	struct rtw89_pci_flush_stats flush_stats;
+
+	/* ring geometry in use, and the one to switch to at next power on */
+	struct rtw89_pci_ring_cfg ring_cfg;
+	struct rtw89_pci_ring_cfg ring_cfg_next;
+	bool ring_cfg_pending;
+	/* BD-RAM partition derived from ring_cfg and chip's bd_ram_table */
+	struct rtw89_pci_bd_ram bd_ram[RTW89_TXCH_NUM];
+
 	void __iomem *mmap;
 };
 
+static inline u32 rtw89_pci_get_intrs(struct rtw89_pci *rtwpci, int idx)
+{
+	return rtwpci->intrs[idx] & ~rtwpci->napi_masked_intrs[idx];
+}
+
 static inline struct rtw89_pci_rx_info *RTW89_PCI_RX_SKB_CB(struct sk_buff *skb)
 {
 	struct ieee80211_tx_info *info = IEEE80211_SKB_CB(skb);
@@ -1544,14 +1720,15 @@ rtw89_pci_dequeue_txwd(struct rtw89_pci_tx_ring *tx_ring)
 	struct rtw89_pci_tx_wd_ring *wd_ring = &tx_ring->wd_ring;
 	struct rtw89_pci_tx_wd *txwd;
 
-	txwd = list_first_entry_or_null(&wd_ring->free_pages,
-					struct rtw89_pci_tx_wd, list);
-	if (!txwd)
+	if (!wd_ring->curr_num)
 		return NULL;
 
-	list_del_init(&txwd->list);
-	txwd->len = 0;
 	wd_ring->curr_num--;
+	txwd = &wd_ring->pages[wd_ring->free_stack[wd_ring->curr_num]];
+	txwd->queued = false;
+	txwd->len = 0;
+	tx_ring->wd_hwm = max(tx_ring->wd_hwm,
+			      wd_ring->page_num - wd_ring->curr_num);
 
 	return txwd;
 }
@@ -1562,9 +1739,32 @@ rtw89_pci_enqueue_txwd(struct rtw89_pci_tx_ring *tx_ring,
 {
 	struct rtw89_pci_tx_wd_ring *wd_ring = &tx_ring->wd_ring;
 
-	memset(txwd->vaddr, 0, wd_ring->page_size);
-	list_add_tail(&txwd->list, &wd_ring->free_pages);
-	wd_ring->curr_num++;
+	/* bytes beyond the length of last submission are still zero */
+	memset(txwd->vaddr, 0, txwd->len);
+	wd_ring->free_stack[wd_ring->curr_num++] = txwd->seq;
+	txwd->queued = true;
+}
+
+/* ACH4~ACH7 and CH10/CH11 carry band 1 frames, see rtw89_core_get_ch_dma() */
+static inline u8 rtw89_pci_txch_band(u8 txch)
+{
+	switch (txch) {
+	case RTW89_TXCH_ACH4 ... RTW89_TXCH_ACH7:
+	case RTW89_TXCH_CH10:
+	case RTW89_TXCH_CH11:
+		return RTW89_MAC_1;
+	default:
+		return RTW89_MAC_0;
+	}
+}
+
+/* Turn a requested ring size into a valid one; 0 requests the default. */
+static inline u16 rtw89_pci_ring_num(u32 num, u32 def, u32 max)
+{
+	if (!num)
+		return def;
+
+	return clamp_t(u32, num, RTW89_PCI_RING_NUM_MIN, max);
 }
 
 static inline bool rtw89_pci_ltr_is_err_reg_val(u32 val)
@@ -1587,12 +1787,18 @@ struct pci_device_id;
 int rtw89_pci_probe(struct pci_dev *pdev, const struct pci_device_id *id);
 void rtw89_pci_remove(struct pci_dev *pdev);
 void rtw89_pci_ops_reset(struct rtw89_dev *rtwdev);
+int rtw89_pci_apply_ring_cfg(struct rtw89_dev *rtwdev);
+u32 rtw89_pci_rx_mit_cnt_max(struct rtw89_dev *rtwdev);
 int rtw89_pci_ltr_set(struct rtw89_dev *rtwdev, bool en);
 int rtw89_pci_ltr_set_v1(struct rtw89_dev *rtwdev, bool en);
 int rtw89_pci_ltr_set_v2(struct rtw89_dev *rtwdev, bool en);
 u32 rtw89_pci_fill_txaddr_info(struct rtw89_dev *rtwdev,
 			       void *txaddr_info_addr, u32 total_len,
 			       dma_addr_t dma, u8 *add_info_nr);
+u32 rtw89_pci_fill_txaddr_info_sg_v1(struct rtw89_dev *rtwdev,
+				     void *txaddr_info_addr,
+				     const struct rtw89_pci_tx_seg *segs,
+				     u8 nr_segs, u8 *add_info_nr);
 u32 rtw89_pci_fill_txaddr_info_v1(struct rtw89_dev *rtwdev,
 				  void *txaddr_info_addr, u32 total_len,
 				  dma_addr_t dma, u8 *add_info_nr);
@@ -368,6 +368,13 @@ static int rtw89_pci_ops_mac_pre_init_be(struct rtw89_dev *rtwdev)
 	}
 
 	rtw89_pci_mode_op_be(rtwdev);
+
+	ret = rtw89_pci_apply_ring_cfg(rtwdev);
+	if (ret) {
+		rtw89_err(rtwdev, "[ERR] apply ring geometry\n");
+		return ret;
+	}
+
 	rtw89_pci_ops_reset(rtwdev);
 
 	ret = rtw89_pci_rst_bdram_be(rtwdev);
@@ -472,12 +479,46 @@ static void rtw89_pci_configure_mit_be(struct rtw89_dev *rtwdev)
 			   B_BE_PCIE_MIT0_RX_TMR_MASK, BE_MIT0_TMR_UNIT_1MS);
 
 	val = rtw89_read32(rtwdev, R_BE_PCIE_MIT0_CNT);
-	cnt = min_t(u32, U8_MAX, RTW89_PCI_RXBD_NUM_MAX / 2);
+	cnt = min_t(u32, U8_MAX, rtw89_pci_rx_mit_cnt_max(rtwdev));
 	val = u32_replace_bits(val, cnt, B_BE_PCIE_RX_MIT0_CNT_MASK);
 	val = u32_replace_bits(val, 2, B_BE_PCIE_RX_MIT0_TMR_CNT_MASK);
 	rtw89_write32(rtwdev, R_BE_PCIE_MIT0_CNT, val);
 }
 
+static const struct rtw89_pci_rx_mit_prof
+rtw89_pci_rx_mit_profs_be[RTW89_PCI_RX_DIM_NUM_PROFS] = {
+	{0, 0},
+	{4, 1000},
+	{16, 1000},
+	{64, 2000},
+	{RTW89_PCI_RX_MIT_CNT_HALF_RING, 2000},
+};
+
+static void rtw89_pci_rx_mit_set_be(struct rtw89_dev *rtwdev,
+				    const struct rtw89_pci_rx_mit_prof *prof)
+{
+	const struct rtw89_pci_info *info = rtwdev->pci_info;
+	u32 tmr_cnt;
+	u32 val;
+
+	if (!prof->cnt) {
+		rtw89_write32(rtwdev, info->mit_addr, 0);
+		return;
+	}
+
+	/* timer unit is set to 1ms by rtw89_pci_configure_mit_be() */
+	tmr_cnt = DIV_ROUND_UP(prof->tmr_us, USEC_PER_MSEC);
+
+	val = rtw89_read32(rtwdev, R_BE_PCIE_MIT0_CNT);
+	val = u32_replace_bits(val, min_t(u32, U8_MAX, prof->cnt),
+			       B_BE_PCIE_RX_MIT0_CNT_MASK);
+	val = u32_replace_bits(val, tmr_cnt, B_BE_PCIE_RX_MIT0_TMR_CNT_MASK);
+	rtw89_write32(rtwdev, R_BE_PCIE_MIT0_CNT, val);
+
+	rtw89_write32(rtwdev, info->mit_addr,
+		      B_BE_PCIE_MIT_RX0P2_EN | B_BE_PCIE_MIT_RX0P1_EN);
+}
+
 static int rtw89_pci_ops_mac_post_init_be(struct rtw89_dev *rtwdev)
 {
 	const struct rtw89_pci_info *info = rtwdev->pci_info;
@@ -614,5 +655,8 @@ const struct rtw89_pci_gen_def rtw89_pci_gen_be = {
 	.aspm_set = rtw89_pci_aspm_set_be,
 	.clkreq_set = rtw89_pci_clkreq_set_be,
 	.l1ss_set = rtw89_pci_l1ss_set_be,
+
+	.rx_mit_profs = rtw89_pci_rx_mit_profs_be,
+	.rx_mit_set = rtw89_pci_rx_mit_set_be,
 };
 EXPORT_SYMBOL(rtw89_pci_gen_be);
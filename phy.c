@@ -1215,6 +1215,8 @@ static void rtw89_phy_bb_reset(struct rtw89_dev *rtwdev,
 	const struct rtw89_chip_info *chip = rtwdev->chip;
 
 	chip->ops->bb_reset(rtwdev, phy_idx);
+	/* don't trust values cached before BB was reset */
+	rtw89_reg_shadow_invalidate(rtwdev);
 }
 
 static void rtw89_phy_config_bb_reg(struct rtw89_dev *rtwdev,
@@ -2675,31 +2677,20 @@ static void rtw89_phy_set_txpwr_limit_ru_ax(struct rtw89_dev *rtwdev,
 	}
 }
 
-struct rtw89_phy_iter_ra_data {
-	struct rtw89_dev *rtwdev;
-	struct sk_buff *c2h;
-};
-
-static void rtw89_phy_c2h_ra_rpt_iter(void *data, struct ieee80211_sta *sta)
+static void rtw89_phy_c2h_ra_rpt_sta(struct rtw89_dev *rtwdev,
+				     struct rtw89_sta *rtwsta,
+				     const struct rtw89_c2h_ra_rpt *c2h)
 {
-	struct rtw89_phy_iter_ra_data *ra_data = (struct rtw89_phy_iter_ra_data *)data;
-	struct rtw89_dev *rtwdev = ra_data->rtwdev;
-	struct rtw89_sta *rtwsta = (struct rtw89_sta *)sta->drv_priv;
-	const struct rtw89_c2h_ra_rpt *c2h =
-		(const struct rtw89_c2h_ra_rpt *)ra_data->c2h->data;
+	struct ieee80211_sta *sta = rtwsta_to_sta(rtwsta);
 	struct rtw89_ra_report *ra_report = &rtwsta->ra_report;
 	const struct rtw89_chip_info *chip = rtwdev->chip;
 	bool format_v1 = chip->chip_gen == RTW89_CHIP_BE;
-	u8 mode, rate, bw, giltf, mac_id;
+	u8 mode, rate, bw, giltf;
 	u16 legacy_bitrate;
 	bool valid;
 	u8 mcs = 0;
 	u8 t;
 
-	mac_id = le32_get_bits(c2h->w2, RTW89_C2H_RA_RPT_W2_MACID);
-	if (mac_id != rtwsta->mac_id)
-		return;
-
 	rate = le32_get_bits(c2h->w3, RTW89_C2H_RA_RPT_W3_MCSNSS);
 	bw = le32_get_bits(c2h->w3, RTW89_C2H_RA_RPT_W3_BW);
 	giltf = le32_get_bits(c2h->w3, RTW89_C2H_RA_RPT_W3_GILTF);
@@ -2802,13 +2793,20 @@ static void rtw89_phy_c2h_ra_rpt_iter(void *data, struct ieee80211_sta *sta)
 static void
 rtw89_phy_c2h_ra_rpt(struct rtw89_dev *rtwdev, struct sk_buff *c2h, u32 len)
 {
-	struct rtw89_phy_iter_ra_data ra_data;
+	const struct rtw89_c2h_ra_rpt *ra_rpt =
+		(const struct rtw89_c2h_ra_rpt *)c2h->data;
+	struct rtw89_sta *rtwsta;
+	u8 mac_id;
 
-	ra_data.rtwdev = rtwdev;
-	ra_data.c2h = c2h;
-	ieee80211_iterate_stations_atomic(rtwdev->hw,
-					  rtw89_phy_c2h_ra_rpt_iter,
-					  &ra_data);
+	mac_id = le32_get_bits(ra_rpt->w2, RTW89_C2H_RA_RPT_W2_MACID);
+
+	rcu_read_lock();
+
+	rtwsta = rtw89_sta_rcu_dereference(rtwdev, mac_id);
+	if (rtwsta)
+		rtw89_phy_c2h_ra_rpt_sta(rtwdev, rtwsta, ra_rpt);
+
+	rcu_read_unlock();
 }
 
 static
@@ -536,11 +536,15 @@ struct rtw89_phy_gen_def {
 extern const struct rtw89_phy_gen_def rtw89_phy_gen_ax;
 extern const struct rtw89_phy_gen_def rtw89_phy_gen_be;
 
+/* BB writes keep rtw89_dev::reg_shadow up to date, so the read of
+ * read-modify-write can be served from it. Other MMIO doesn't touch it.
+ */
 static inline void rtw89_phy_write8(struct rtw89_dev *rtwdev,
 				    u32 addr, u8 data)
 {
 	const struct rtw89_phy_gen_def *phy = rtwdev->chip->phy_def;
 
+	rtw89_reg_shadow_drop(rtwdev, addr + phy->cr_base);
 	rtw89_write8(rtwdev, addr + phy->cr_base, data);
 }
 
@@ -549,6 +553,7 @@ static inline void rtw89_phy_write16(struct rtw89_dev *rtwdev,
 {
 	const struct rtw89_phy_gen_def *phy = rtwdev->chip->phy_def;
 
+	rtw89_reg_shadow_drop(rtwdev, addr + phy->cr_base);
 	rtw89_write16(rtwdev, addr + phy->cr_base, data);
 }
 
@@ -557,31 +562,47 @@ static inline void rtw89_phy_write32(struct rtw89_dev *rtwdev,
 {
 	const struct rtw89_phy_gen_def *phy = rtwdev->chip->phy_def;
 
+	rtw89_reg_shadow_update(rtwdev, addr + phy->cr_base, data);
 	rtw89_write32(rtwdev, addr + phy->cr_base, data);
 }
 
+static inline u32 rtw89_phy_read32_rmw(struct rtw89_dev *rtwdev, u32 addr)
+{
+	const struct rtw89_phy_gen_def *phy = rtwdev->chip->phy_def;
+
+	return rtw89_read32_rmw(rtwdev, addr + phy->cr_base);
+}
+
 static inline void rtw89_phy_write32_set(struct rtw89_dev *rtwdev,
 					 u32 addr, u32 bits)
 {
-	const struct rtw89_phy_gen_def *phy = rtwdev->chip->phy_def;
+	u32 val;
 
-	rtw89_write32_set(rtwdev, addr + phy->cr_base, bits);
+	val = rtw89_phy_read32_rmw(rtwdev, addr);
+	rtw89_phy_write32(rtwdev, addr, val | bits);
 }
 
 static inline void rtw89_phy_write32_clr(struct rtw89_dev *rtwdev,
 					 u32 addr, u32 bits)
 {
-	const struct rtw89_phy_gen_def *phy = rtwdev->chip->phy_def;
+	u32 val;
 
-	rtw89_write32_clr(rtwdev, addr + phy->cr_base, bits);
+	val = rtw89_phy_read32_rmw(rtwdev, addr);
+	rtw89_phy_write32(rtwdev, addr, val & ~bits);
 }
 
 static inline void rtw89_phy_write32_mask(struct rtw89_dev *rtwdev,
 					  u32 addr, u32 mask, u32 data)
 {
-	const struct rtw89_phy_gen_def *phy = rtwdev->chip->phy_def;
+	u32 shift = __ffs(mask);
+	u32 orig;
+	u32 set;
+
+	WARN(addr & 0x3, "should be 4-byte aligned, addr = 0x%08x\n", addr);
 
-	rtw89_write32_mask(rtwdev, addr + phy->cr_base, mask, data);
+	orig = rtw89_phy_read32_rmw(rtwdev, addr);
+	set = (orig & ~mask) | ((data << shift) & mask);
+	rtw89_phy_write32(rtwdev, addr, set);
 }
 
 static inline u8 rtw89_phy_read8(struct rtw89_dev *rtwdev, u32 addr)
@@ -46,11 +46,8 @@ static void rtw89_ps_power_mode_change_with_hci(struct rtw89_dev *rtwdev,
 
 	rtwdev->hci.paused = false;
 
-	if (!enter) {
-		local_bh_disable();
-		napi_schedule(&rtwdev->napi);
-		local_bh_enable();
-	}
+	if (!enter)
+		rtw89_core_napi_schedule_all(rtwdev);
 }
 
 static void rtw89_ps_power_mode_change(struct rtw89_dev *rtwdev, bool enter)
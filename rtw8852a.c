@@ -2161,6 +2161,7 @@ const struct rtw89_chip_info rtw8852a_chip_info = {
 	.txpwr_factor_mac	= 1,
 	.dig_table		= &rtw89_8852a_phy_dig_table,
 	.dig_regs		= &rtw8852a_dig_regs,
+	.reg_shadow		= NULL,
 	.tssi_dbw_table		= NULL,
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 4, 0)
 	.support_chanctx_num	= 1,
@@ -2609,6 +2609,7 @@ const struct rtw89_chip_info rtw8852b_chip_info = {
 	.txpwr_factor_mac	= 1,
 	.dig_table		= NULL,
 	.dig_regs		= &rtw8852b_dig_regs,
+	.reg_shadow		= NULL,
 	.tssi_dbw_table		= NULL,
 	.support_chanctx_num	= 0,
 	.support_rnr		= false,
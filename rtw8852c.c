@@ -167,6 +167,20 @@ static const struct rtw89_dig_regs rtw8852c_dig_regs = {
 			      B_PATH1_S20_FOLLOW_BY_PAGCUGC_EN_MSK},
 };
 
+static const u32 rtw8852c_shadow_phy_regs[] = {
+	R_SEG0R_PD, R_BMODE_PDTH_EN_V1, R_BMODE_PDTH_V1,
+	R_PATH0_LNA_INIT_V1, R_PATH1_LNA_INIT_V1,
+	R_PATH0_TIA_INIT_V1, R_PATH1_TIA_INIT_V1,
+	R_PATH0_RXB_INIT_V1, R_PATH1_RXB_INIT_V1,
+	R_PATH0_P20_FOLLOW_BY_PAGCUGC_V1, R_PATH0_S20_FOLLOW_BY_PAGCUGC_V1,
+	R_PATH1_P20_FOLLOW_BY_PAGCUGC_V1, R_PATH1_S20_FOLLOW_BY_PAGCUGC_V1,
+};
+
+static const struct rtw89_reg_shadow_cfg rtw8852c_reg_shadow = {
+	.phy_regs = rtw8852c_shadow_phy_regs,
+	.n_phy_regs = ARRAY_SIZE(rtw8852c_shadow_phy_regs),
+};
+
 static const struct rtw89_edcca_regs rtw8852c_edcca_regs = {
 	.edcca_level			= R_SEG0R_EDCCA_LVL,
 	.edcca_mask			= B_EDCCA_LVL_MSK0,
@@ -1504,6 +1518,7 @@ static void rtw8852c_bb_reset_all(struct rtw89_dev *rtwdev,
 
 	rtw89_phy_write32_idx(rtwdev, R_RSTB_ASYNC, B_RSTB_ASYNC_ALL, 1,
 			      phy_idx);
+	rtw89_reg_shadow_invalidate(rtwdev);
 }
 
 static void rtw8852c_bb_reset_en(struct rtw89_dev *rtwdev, enum rtw89_band band,
@@ -1529,6 +1544,7 @@ static void rtw8852c_bb_reset_en(struct rtw89_dev *rtwdev, enum rtw89_band band,
 		fsleep(1);
 		rtw89_phy_write32_idx(rtwdev, R_RSTB_ASYNC, B_RSTB_ASYNC_ALL, 0,
 				      phy_idx);
+		rtw89_reg_shadow_invalidate(rtwdev);
 	}
 }
 
@@ -2940,6 +2956,7 @@ const struct rtw89_chip_info rtw8852c_chip_info = {
 	.txpwr_factor_mac	= 1,
 	.dig_table		= NULL,
 	.dig_regs		= &rtw8852c_dig_regs,
+	.reg_shadow		= &rtw8852c_reg_shadow,
 	.tssi_dbw_table		= &rtw89_8852c_tssi_dbw_table,
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 4, 0)
 	.support_chanctx_num	= 2,
@@ -2543,6 +2543,7 @@ const struct rtw89_chip_info rtw8922a_chip_info = {
 	.txpwr_factor_mac	= 1,
 	.dig_table		= NULL,
 	.dig_regs		= &rtw8922a_dig_regs,
+	.reg_shadow		= NULL,
 	.tssi_dbw_table		= NULL,
 	.support_chanctx_num	= 2,
 	.support_rnr		= true,
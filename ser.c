@@ -474,6 +474,7 @@ static void ser_reset_trx_st_hdl(struct rtw89_ser *ser, u8 evt)
 
 		drv_stop_rx(ser);
 		drv_trx_reset(ser);
+		rtw89_reg_shadow_invalidate(rtwdev);
 
 		/* wait m3 */
 		hal_send_m2_event(ser);
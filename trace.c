@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: GPL-2.0 OR BSD-3-Clause
+/* Copyright(c) 2019-2020  Realtek Corporation
+ */
+
+#include <linux/module.h>
+
+#define CREATE_TRACE_POINTS
+#include "trace.h"
+
+EXPORT_TRACEPOINT_SYMBOL_GPL(rtw89_pci_tx_kick_off);
+EXPORT_TRACEPOINT_SYMBOL_GPL(rtw89_pci_release_rpp);
+EXPORT_TRACEPOINT_SYMBOL_GPL(rtw89_pci_rxbd_deliver);
+EXPORT_TRACEPOINT_SYMBOL_GPL(rtw89_pci_napi_poll);
@@ -0,0 +1,242 @@
+/* SPDX-License-Identifier: GPL-2.0 OR BSD-3-Clause */
+/* Copyright(c) 2019-2020  Realtek Corporation
+ */
+
+#if !defined(__RTW89_TRACE_H__) || defined(TRACE_HEADER_MULTI_READ)
+#define __RTW89_TRACE_H__
+
+#include <linux/tracepoint.h>
+#include "core.h"
+#include "fw.h"
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM rtw89
+
+/* NAPI poll contexts of rtw89_pci_napi_poll */
+#define RTW89_TRACE_NAPI_RXQ		0
+#define RTW89_TRACE_NAPI_RPQ		1
+#define RTW89_TRACE_NAPI_LOW_POWER	2
+
+TRACE_EVENT(rtw89_core_tx_write,
+	TP_PROTO(struct rtw89_dev *rtwdev,
+		 const struct rtw89_tx_desc_info *desc_info),
+
+	TP_ARGS(rtwdev, desc_info),
+
+	TP_STRUCT__entry(
+		__field(int, phy)
+		__field(u8, mac_id)
+		__field(u8, qsel)
+		__field(u8, ch_dma)
+		__field(u16, len)
+		__field(u16, seq)
+	),
+
+	TP_fast_assign(
+		__entry->phy = rtwdev->hw->wiphy->wiphy_idx;
+		__entry->mac_id = desc_info->mac_id;
+		__entry->qsel = desc_info->qsel;
+		__entry->ch_dma = desc_info->ch_dma;
+		__entry->len = desc_info->pkt_size;
+		__entry->seq = desc_info->seq;
+	),
+
+	TP_printk("phy%d mac_id=%u qsel=%u ch=%u len=%u seq=%u",
+		  __entry->phy, __entry->mac_id, __entry->qsel,
+		  __entry->ch_dma, __entry->len, __entry->seq)
+);
+
+TRACE_EVENT(rtw89_h2c_tx,
+	TP_PROTO(struct rtw89_dev *rtwdev, const struct sk_buff *skb, bool fwdl),
+
+	TP_ARGS(rtwdev, skb, fwdl),
+
+	TP_STRUCT__entry(
+		__field(int, phy)
+		__field(u8, cat)
+		__field(u8, class)
+		__field(u8, func)
+		__field(u32, len)
+		__field(bool, fwdl)
+	),
+
+	TP_fast_assign(
+		u32 hdr0 = !fwdl && skb->len >= sizeof(__le32) ?
+			   le32_to_cpu(*(const __le32 *)skb->data) : 0;
+
+		__entry->phy = rtwdev->hw->wiphy->wiphy_idx;
+		__entry->cat = FIELD_GET(H2C_HDR_CAT, hdr0);
+		__entry->class = FIELD_GET(H2C_HDR_CLASS, hdr0);
+		__entry->func = FIELD_GET(H2C_HDR_FUNC, hdr0);
+		__entry->len = skb->len;
+		__entry->fwdl = fwdl;
+	),
+
+	TP_printk("phy%d cat=%u class=0x%x func=0x%x len=%u fwdl=%d",
+		  __entry->phy, __entry->cat, __entry->class,
+		  __entry->func, __entry->len, __entry->fwdl)
+);
+
+TRACE_EVENT(rtw89_fw_c2h,
+	TP_PROTO(struct rtw89_dev *rtwdev, const struct rtw89_fw_c2h_attr *attr),
+
+	TP_ARGS(rtwdev, attr),
+
+	TP_STRUCT__entry(
+		__field(int, phy)
+		__field(u8, cat)
+		__field(u8, class)
+		__field(u8, func)
+		__field(u16, len)
+	),
+
+	TP_fast_assign(
+		__entry->phy = rtwdev->hw->wiphy->wiphy_idx;
+		__entry->cat = attr->category;
+		__entry->class = attr->class;
+		__entry->func = attr->func;
+		__entry->len = attr->len;
+	),
+
+	TP_printk("phy%d cat=%u class=0x%x func=0x%x len=%u",
+		  __entry->phy, __entry->cat, __entry->class,
+		  __entry->func, __entry->len)
+);
+
+TRACE_EVENT(rtw89_core_rx,
+	TP_PROTO(struct rtw89_dev *rtwdev,
+		 const struct rtw89_rx_desc_info *desc_info),
+
+	TP_ARGS(rtwdev, desc_info),
+
+	TP_STRUCT__entry(
+		__field(int, phy)
+		__field(u8, pkt_type)
+		__field(u8, mac_id)
+		__field(u8, ppdu_cnt)
+		__field(u8, bb_sel)
+		__field(u16, rate)
+		__field(u16, len)
+	),
+
+	TP_fast_assign(
+		__entry->phy = rtwdev->hw->wiphy->wiphy_idx;
+		__entry->pkt_type = desc_info->pkt_type;
+		__entry->mac_id = desc_info->mac_id;
+		__entry->ppdu_cnt = desc_info->ppdu_cnt;
+		__entry->bb_sel = desc_info->bb_sel;
+		__entry->rate = desc_info->data_rate;
+		__entry->len = desc_info->pkt_size;
+	),
+
+	TP_printk("phy%d type=%u mac_id=%u band=%u ppdu_cnt=%u rate=0x%x len=%u",
+		  __entry->phy, __entry->pkt_type, __entry->mac_id,
+		  __entry->bb_sel, __entry->ppdu_cnt, __entry->rate,
+		  __entry->len)
+);
+
+TRACE_EVENT(rtw89_pci_tx_kick_off,
+	TP_PROTO(struct rtw89_dev *rtwdev, u8 txch, u32 wp),
+
+	TP_ARGS(rtwdev, txch, wp),
+
+	TP_STRUCT__entry(
+		__field(int, phy)
+		__field(u8, txch)
+		__field(u32, wp)
+	),
+
+	TP_fast_assign(
+		__entry->phy = rtwdev->hw->wiphy->wiphy_idx;
+		__entry->txch = txch;
+		__entry->wp = wp;
+	),
+
+	TP_printk("phy%d txch=%u wp=%u",
+		  __entry->phy, __entry->txch, __entry->wp)
+);
+
+TRACE_EVENT(rtw89_pci_release_rpp,
+	TP_PROTO(struct rtw89_dev *rtwdev, u8 txch, u16 seq, u8 status),
+
+	TP_ARGS(rtwdev, txch, seq, status),
+
+	TP_STRUCT__entry(
+		__field(int, phy)
+		__field(u8, txch)
+		__field(u16, seq)
+		__field(u8, status)
+	),
+
+	TP_fast_assign(
+		__entry->phy = rtwdev->hw->wiphy->wiphy_idx;
+		__entry->txch = txch;
+		__entry->seq = seq;
+		__entry->status = status;
+	),
+
+	TP_printk("phy%d txch=%u seq=%u status=%u",
+		  __entry->phy, __entry->txch, __entry->seq, __entry->status)
+);
+
+TRACE_EVENT(rtw89_pci_rxbd_deliver,
+	TP_PROTO(struct rtw89_dev *rtwdev, u32 idx, u32 len, bool fs, bool ls),
+
+	TP_ARGS(rtwdev, idx, len, fs, ls),
+
+	TP_STRUCT__entry(
+		__field(int, phy)
+		__field(u32, idx)
+		__field(u32, len)
+		__field(bool, fs)
+		__field(bool, ls)
+	),
+
+	TP_fast_assign(
+		__entry->phy = rtwdev->hw->wiphy->wiphy_idx;
+		__entry->idx = idx;
+		__entry->len = len;
+		__entry->fs = fs;
+		__entry->ls = ls;
+	),
+
+	TP_printk("phy%d idx=%u len=%u fs=%d ls=%d",
+		  __entry->phy, __entry->idx, __entry->len,
+		  __entry->fs, __entry->ls)
+);
+
+TRACE_EVENT(rtw89_pci_napi_poll,
+	TP_PROTO(struct rtw89_dev *rtwdev, u8 ctx, int budget, int work_done),
+
+	TP_ARGS(rtwdev, ctx, budget, work_done),
+
+	TP_STRUCT__entry(
+		__field(int, phy)
+		__field(u8, ctx)
+		__field(int, budget)
+		__field(int, work_done)
+	),
+
+	TP_fast_assign(
+		__entry->phy = rtwdev->hw->wiphy->wiphy_idx;
+		__entry->ctx = ctx;
+		__entry->budget = budget;
+		__entry->work_done = work_done;
+	),
+
+	TP_printk("phy%d %s budget=%d work_done=%d", __entry->phy,
+		  __print_symbolic(__entry->ctx,
+				   { RTW89_TRACE_NAPI_RXQ, "rxq" },
+				   { RTW89_TRACE_NAPI_RPQ, "rpq" },
+				   { RTW89_TRACE_NAPI_LOW_POWER, "low_power" }),
+		  __entry->budget, __entry->work_done)
+);
+
+#endif /* __RTW89_TRACE_H__ */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE trace
+
+#include <trace/define_trace.h>
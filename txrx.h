@@ -642,6 +642,22 @@ static inline u8 rtw89_core_get_qsel(struct rtw89_dev *rtwdev, u8 tid)
 	}
 }
 
+/* Under DBCC, band 1 has its own AC queues which are fetched through
+ * ACH4~ACH7, so it doesn't share DMA rings with band 0. For now every vif
+ * is added on RTW89_MAC_0, so this takes effect once a vif is placed on
+ * RTW89_MAC_1.
+ */
+static inline u8 rtw89_core_get_qsel_band(struct rtw89_dev *rtwdev, u8 tid,
+					  u8 mac_idx)
+{
+	u8 qsel = rtw89_core_get_qsel(rtwdev, tid);
+
+	if (rtwdev->dbcc_en && mac_idx == RTW89_MAC_1)
+		qsel += RTW89_TX_QSEL_BE_1 - RTW89_TX_QSEL_BE_0;
+
+	return qsel;
+}
+
 static inline u8 rtw89_core_get_ch_dma(struct rtw89_dev *rtwdev, u8 qsel)
 {
 	switch (qsel) {
@@ -656,6 +672,14 @@ static inline u8 rtw89_core_get_ch_dma(struct rtw89_dev *rtwdev, u8 qsel)
 		return RTW89_TXCH_ACH2;
 	case RTW89_TX_QSEL_VO_0:
 		return RTW89_TXCH_ACH3;
+	case RTW89_TX_QSEL_BE_1:
+		return RTW89_TXCH_ACH4;
+	case RTW89_TX_QSEL_BK_1:
+		return RTW89_TXCH_ACH5;
+	case RTW89_TX_QSEL_VI_1:
+		return RTW89_TXCH_ACH6;
+	case RTW89_TX_QSEL_VO_1:
+		return RTW89_TXCH_ACH7;
 	case RTW89_TX_QSEL_B0_MGMT:
 		return RTW89_TXCH_CH8;
 	case RTW89_TX_QSEL_B0_HI: